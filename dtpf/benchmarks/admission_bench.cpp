@@ -0,0 +1,106 @@
+// Sustained overload: producers submit payload-carrying tasks faster than the
+// workers finish them, unbounded and under each overload policy
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dtpf/admission_queue.hpp"
+
+using namespace dtpf;
+
+namespace {
+
+struct Work {
+    std::string payload;
+    std::chrono::steady_clock::time_point submitted;
+};
+
+void run_phase(const char* name, AdmissionOptions options, size_t tasks, size_t payload_bytes,
+               std::chrono::microseconds work) {
+    AdmissionQueue<Work> queue(options);
+    std::atomic<std::uint64_t> max_wait_us{0};
+
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < options.max_in_flight; ++w) {
+        workers.emplace_back([&] {
+            while (auto lease = queue.pop()) {
+                auto start = std::chrono::steady_clock::now();
+                auto waited = std::chrono::duration_cast<std::chrono::microseconds>(start - lease->item.submitted);
+                std::uint64_t seen = max_wait_us.load();
+                while (static_cast<std::uint64_t>(waited.count()) > seen &&
+                       !max_wait_us.compare_exchange_weak(seen, waited.count())) {
+                }
+                std::this_thread::sleep_for(work);
+                lease->item.payload.clear();
+                lease->item.payload.shrink_to_fit();
+                queue.finish(*lease, std::chrono::steady_clock::now() - start);
+            }
+        });
+    }
+
+    // Two producers, each submitting as fast as admission lets it
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> producers;
+    for (size_t p = 0; p < 2; ++p) {
+        producers.emplace_back([&, p] {
+            std::vector<AdmissionQueue<Work>::Lease> shed;
+            for (size_t i = p; i < tasks; i += 2) {
+                int priority = static_cast<int>(i % 4);
+                queue.push(Work{std::string(payload_bytes, 'x'), std::chrono::steady_clock::now()},
+                           priority, payload_bytes, shed);
+                shed.clear();
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    queue.close();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    auto stats = queue.stats();
+
+    std::printf("%-12s %8.3f s %9llu %9llu %9llu %10.1f MB %10.1f ms\n", name, elapsed.count(),
+                static_cast<unsigned long long>(stats.completed), static_cast<unsigned long long>(stats.rejected),
+                static_cast<unsigned long long>(stats.shed), static_cast<double>(stats.peak_bytes) / (1 << 20),
+                static_cast<double>(max_wait_us.load()) / 1000.0);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t tasks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    size_t payload_bytes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 64 * 1024;
+    auto work = std::chrono::microseconds(argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 200);
+
+    AdmissionOptions bounded;
+    bounded.max_in_flight = 4;
+    bounded.max_queued = 256;
+    bounded.memory_budget = 16 * 1024 * 1024;
+
+    AdmissionOptions unbounded = bounded;
+    unbounded.max_queued = std::numeric_limits<size_t>::max();
+    unbounded.memory_budget = std::numeric_limits<size_t>::max();
+
+    std::printf("%zu tasks of %zu bytes, %lld us of work each, 4 workers\n", tasks, payload_bytes,
+                static_cast<long long>(work.count()));
+    std::printf("%-12s %10s %9s %9s %9s %13s %13s\n", "", "elapsed", "completed", "rejected", "shed", "peak memory",
+                "max wait");
+    run_phase("unbounded", unbounded, tasks, payload_bytes, work);
+    for (auto [name, policy] : {std::pair{"block", OverloadPolicy::Block}, std::pair{"reject", OverloadPolicy::Reject},
+                                std::pair{"shed lowest", OverloadPolicy::ShedLowest}}) {
+        AdmissionOptions options = bounded;
+        options.policy = policy;
+        run_phase(name, options, tasks, payload_bytes, work);
+    }
+    return 0;
+}
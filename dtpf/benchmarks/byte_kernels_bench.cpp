@@ -0,0 +1,113 @@
+// Single-core throughput of every byte kernel on every supported instruction set
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dtpf/byte_kernels.hpp"
+
+using namespace dtpf;
+
+namespace {
+
+// Mostly printable text with occasional control and high bytes, so the
+// filter takes both its fast and its slow path
+std::string make_input(size_t size) {
+    std::mt19937_64 rng(42);
+    std::string input(size, '\0');
+    for (auto& c : input) {
+        std::uint64_t r = rng();
+        if (r % 64 == 0) {
+            c = static_cast<char>(r >> 8);
+        } else if (r % 40 == 1) {
+            c = '\n';
+        } else {
+            c = static_cast<char>(' ' + (r >> 8) % 95);
+        }
+    }
+    return input;
+}
+
+// Best of several runs, in GB/s
+template<typename Kernel>
+double measure(const std::string& input, size_t rounds, Kernel&& kernel) {
+    double best = 0.0;
+    for (int run = 0; run < 5; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t round = 0; round < rounds; ++round) {
+            kernel();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::max(best, static_cast<double>(input.size() * rounds) / elapsed.count() / 1e9);
+    }
+    return best;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    // The default buffer fits in L2, which measures the kernels rather than memory
+    size_t kib = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+    std::string input = make_input(std::max<size_t>(kib, 1) * 1024);
+    std::string output(input.size(), '\0');
+    size_t rounds = std::max<size_t>(1, (size_t{1} << 30) / input.size() / 4);
+    volatile std::uint64_t sink = 0;
+
+    std::vector<const ByteKernels*> sets;
+    for (const char* isa : {"scalar", "sse4.2", "avx2"}) {
+        if (const ByteKernels* kernels = byte_kernels_for(isa)) {
+            sets.push_back(kernels);
+        }
+    }
+
+    std::printf("Byte kernels, %zu KiB buffer, GB/s on one core (dispatch picks %s)\n\n", input.size() / 1024,
+                byte_kernels().isa);
+    std::printf("%-14s", "kernel");
+    for (const ByteKernels* kernels : sets) {
+        std::printf("%10s", kernels->isa);
+    }
+    std::printf("\n");
+
+    struct Row {
+        const char* name;
+        void (*run)(const ByteKernels&, const std::string&, std::string&, volatile std::uint64_t&);
+    };
+    const Row rows[] = {
+        {"upper", [](const ByteKernels& k, const std::string& in, std::string& out, volatile std::uint64_t&) {
+             k.to_upper(in.data(), in.size(), out.data());
+         }},
+        {"lower", [](const ByteKernels& k, const std::string& in, std::string& out, volatile std::uint64_t&) {
+             k.to_lower(in.data(), in.size(), out.data());
+         }},
+        {"filter", [](const ByteKernels& k, const std::string& in, std::string& out, volatile std::uint64_t& s) {
+             s = s + k.filter_printable(in.data(), in.size(), out.data());
+         }},
+        {"count_digits", [](const ByteKernels& k, const std::string& in, std::string&, volatile std::uint64_t& s) {
+             s = s + k.count_class(in.data(), in.size(), CharClass::Digit);
+         }},
+        {"count_alpha", [](const ByteKernels& k, const std::string& in, std::string&, volatile std::uint64_t& s) {
+             s = s + k.count_class(in.data(), in.size(), CharClass::Alpha);
+         }},
+        {"count_lines", [](const ByteKernels& k, const std::string& in, std::string&, volatile std::uint64_t& s) {
+             s = s + k.count_byte(in.data(), in.size(), '\n');
+         }},
+        {"checksum", [](const ByteKernels& k, const std::string& in, std::string&, volatile std::uint64_t& s) {
+             s = s + k.crc32c(0, in.data(), in.size());
+         }},
+    };
+
+    for (const Row& row : rows) {
+        std::printf("%-14s", row.name);
+        for (const ByteKernels* kernels : sets) {
+            double rate = measure(input, rounds, [&] { row.run(*kernels, input, output, sink); });
+            std::printf("%10.2f", rate);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
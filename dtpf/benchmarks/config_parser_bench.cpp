@@ -0,0 +1,164 @@
+// Config parsing: the former std::regex scans, one pass per statement kind
+// plus one per block, against ConfigParser::parse. Their results are
+// compared in tests/config_parser_test.cpp.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../config_parser.cpp"
+
+using namespace dtpf;
+
+namespace {
+
+struct Counts {
+    std::uint64_t tasks = 0;
+    std::uint64_t nodes = 0;
+    std::uint64_t routes = 0;
+    std::uint64_t pipelines = 0;
+    std::int64_t priorities = 0; // keeps the parsed values live
+
+    bool operator==(const Counts&) const = default;
+};
+
+std::string make_config(size_t bytes) {
+    std::string config;
+    config.reserve(bytes + 512);
+    config.append("global {\n    threads = \"4\"\n    banner = \"} {\"\n    limits { depth = 2 }\n}\n");
+    for (size_t i = 0; config.size() < bytes; ++i) {
+        std::string n = std::to_string(i);
+        config.append("# block ").append(n);
+        config.append("\nnode: worker").append(n);
+        config.append(" {\n    address = \"10.0.").append(std::to_string(i % 256));
+        config.append(".1\"\n    port = \"9000\"\n    max_workers = \"8\"\n}\n");
+        config.append("task: Computation {\n    iterations = \"").append(std::to_string(i % 40));
+        config.append("\"\n    algorithm = \"fibonacci\"\n    priority = \"").append(std::to_string(i % 10));
+        config.append("\"\n    node = \"worker").append(n).append("\"\n}\n");
+        config.append("task: DataProcessing {\n    input = \"dataset_").append(n);
+        config.append("\"\n    multiplier = \"3\"\n}\n");
+        config.append("route: ingest").append(n).append(" -> worker").append(n).append("\n");
+        config.append("pipeline: load -> transform -> store\n");
+    }
+    return config;
+}
+
+// The scans the regex ConfigParser made
+Counts parse_with_regex(const std::string& config) {
+    static const std::regex task_pattern{R"(task\s*:\s*(\w+)\s*\{([^}]*)\})"};
+    static const std::regex node_pattern{R"(node\s*:\s*(\w+)\s*\{([^}]*)\})"};
+    static const std::regex property_pattern("(\\w+)\\s*=\\s*\"([^\"]*)\"");
+    static const std::regex routing_pattern{R"(route\s*:\s*(\w+)\s*->\s*(\w+)(?:\s*where\s+(.+))?)"};
+    static const std::regex pipeline_pattern{R"(pipeline\s*:\s*(.+))"};
+    static const std::regex stage_delimiter{R"(\s*->\s*)"};
+    std::sregex_iterator end;
+    Counts counts;
+
+    for (std::sregex_iterator it(config.begin(), config.end(), task_pattern); it != end; ++it) {
+        TaskConfig task;
+        task.type = (*it)[1].str();
+        std::string properties = (*it)[2].str();
+        for (std::sregex_iterator p(properties.begin(), properties.end(), property_pattern); p != end; ++p) {
+            task.properties[(*p)[1].str()] = (*p)[2].str();
+            if ((*p)[1].str() == "priority") {
+                task.priority = std::stoi((*p)[2].str());
+            }
+        }
+        ++counts.tasks;
+        counts.priorities += task.priority;
+    }
+    for (std::sregex_iterator it(config.begin(), config.end(), node_pattern); it != end; ++it) {
+        std::string properties = (*it)[2].str();
+        std::map<std::string, std::string> parsed;
+        for (std::sregex_iterator p(properties.begin(), properties.end(), property_pattern); p != end; ++p) {
+            parsed[(*p)[1].str()] = (*p)[2].str();
+        }
+        counts.nodes += !parsed.empty();
+    }
+    for (std::sregex_iterator it(config.begin(), config.end(), routing_pattern); it != end; ++it) {
+        std::string from = (*it)[1].str();
+        std::string to = (*it)[2].str();
+        counts.routes += !from.empty() && !to.empty();
+    }
+    for (std::sregex_iterator it(config.begin(), config.end(), pipeline_pattern); it != end; ++it) {
+        std::string stages = (*it)[1].str();
+        std::vector<std::string> split;
+        for (std::sregex_token_iterator s(stages.begin(), stages.end(), stage_delimiter, -1);
+             s != std::sregex_token_iterator{}; ++s) {
+            split.push_back(s->str());
+        }
+        counts.pipelines += !split.empty();
+    }
+    return counts;
+}
+
+// The shipped parser, reduced to the same counts
+Counts parse_by_hand(std::string_view config) {
+    auto parsed = ConfigParser::parse(config);
+    Counts counts;
+    counts.tasks = parsed.tasks.size();
+    for (const auto& task : parsed.tasks) {
+        counts.priorities += task.priority;
+    }
+    for (const auto& node : parsed.nodes) {
+        counts.nodes += !node.properties.empty();
+    }
+    for (const auto& route : parsed.routes) {
+        counts.routes += !route.from_node.empty() && !route.to_node.empty();
+    }
+    for (const auto& pipeline : parsed.pipelines) {
+        counts.pipelines += !pipeline.stages.empty();
+    }
+    return counts;
+}
+
+template<typename Body>
+double seconds(Body&& body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+// Arguments: config sizes in MB; regex runs are skipped above DTPF_REGEX_MAX_MB (default 64)
+int main(int argc, char* argv[]) {
+    std::vector<size_t> sizes_mb;
+    for (int i = 1; i < argc; ++i) {
+        sizes_mb.push_back(std::strtoul(argv[i], nullptr, 10));
+    }
+    if (sizes_mb.empty()) {
+        sizes_mb = {1, 16, 64, 1024};
+    }
+    const char* limit = std::getenv("DTPF_REGEX_MAX_MB");
+    size_t regex_max_mb = limit ? std::strtoul(limit, nullptr, 10) : 64;
+
+    std::printf("%8s %10s %12s %12s %12s %9s\n", "size", "tasks", "regex", "hand-written", "MB/s", "speedup");
+    for (size_t mb : sizes_mb) {
+        std::string config = make_config(mb << 20);
+        Counts by_hand;
+        double hand = seconds([&] { by_hand = parse_by_hand(config); });
+        double throughput = static_cast<double>(config.size()) / (1 << 20) / hand;
+
+        if (mb > regex_max_mb) {
+            std::printf("%6zuMB %10llu %12s %10.3f s %12.0f %9s\n", mb,
+                        static_cast<unsigned long long>(by_hand.tasks), "-", hand, throughput, "-");
+            continue;
+        }
+        Counts by_regex;
+        double regex = seconds([&] { by_regex = parse_with_regex(config); });
+        if (!(by_regex == by_hand)) {
+            std::fprintf(stderr, "parsers disagree at %zu MB\n", mb);
+            return 1;
+        }
+        std::printf("%6zuMB %10llu %10.3f s %10.3f s %12.0f %8.1fx\n", mb,
+                    static_cast<unsigned long long>(by_hand.tasks), regex, hand, throughput, regex / hand);
+    }
+    return 0;
+}
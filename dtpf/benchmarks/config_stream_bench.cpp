@@ -0,0 +1,142 @@
+// Config ingestion: reading and parsing the whole file before the first task
+// runs, against streaming each task block to the workers as it closes
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "dtpf/config_stream.hpp"
+
+using namespace dtpf;
+
+#ifdef DTPF_HAS_MMAP
+
+#include <sys/resource.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void write_config(const std::string& path, size_t tasks) {
+    std::ofstream out(path);
+    for (size_t i = 0; i < tasks; ++i) {
+        out << "task: Computation {\n    iterations = \"" << 10 + i % 20
+            << "\"\n    algorithm = \"fibonacci\"\n    priority = \"" << i % 10 << "\"\n}\n";
+    }
+}
+
+// A few microseconds of work per task, as a small computation would take
+std::uint64_t run_task(const TaskConfig& config) {
+    std::uint64_t iterations = std::strtoull(config.get_property("iterations").c_str(), nullptr, 10);
+    std::uint64_t a = 0;
+    std::uint64_t b = 1;
+    for (std::uint64_t i = 0; i < iterations * 50; ++i) {
+        std::uint64_t next = a + b;
+        a = b;
+        b = next;
+    }
+    return a;
+}
+
+// Peak resident memory of the process so far; the streaming phase runs first
+double peak_rss_mb() {
+    rusage usage{};
+    ::getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<double>(usage.ru_maxrss) / (1 << 20);
+#else
+    return static_cast<double>(usage.ru_maxrss) / 1024;
+#endif
+}
+
+struct Phase {
+    Clock::time_point start = Clock::now();
+    std::atomic<std::int64_t> first_start_us{-1};
+    std::uint64_t checksum = 0;
+
+    void started() {
+        std::int64_t expected = -1;
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+        first_start_us.compare_exchange_strong(expected, us);
+    }
+
+    void report(const char* name, size_t tasks) const {
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        std::printf("%-16s %10zu %12.3f ms %10.3f s %12.1f MB %20llu\n", name, tasks,
+                    static_cast<double>(first_start_us.load()) / 1000.0, elapsed.count(), peak_rss_mb(),
+                    static_cast<unsigned long long>(checksum));
+    }
+};
+
+void run_streaming(const std::string& path, const ConfigStreamOptions& options) {
+    Phase phase;
+    size_t tasks = stream_config_file(path, [&](TaskConfig&& config) {
+        phase.started();
+        return run_task(config);
+    }, [&](size_t, std::uint64_t result) { phase.checksum += result; }, options);
+    phase.report("streaming", tasks);
+}
+
+void run_read_then_run(const std::string& path, const ConfigStreamOptions& options) {
+    Phase phase;
+    std::ifstream in(path);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string config = buffer.str();
+
+    std::vector<TaskConfig> configs;
+    ConfigStatementParser parser(config);
+    ConfigStatement statement;
+    while (parser.next(statement)) {
+        if (statement.kind == ConfigStatement::Kind::Task) {
+            configs.push_back(make_task_config(statement));
+        }
+    }
+
+    StreamOptions stream;
+    stream.max_in_flight = options.max_in_flight;
+    stream.buffer_capacity = options.buffer_capacity;
+    stream_results(configs.size(), [&](size_t i) {
+        phase.started();
+        return run_task(configs[i]);
+    }, [&](size_t, std::uint64_t result) { phase.checksum += result; }, stream);
+    phase.report("read then run", configs.size());
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t tasks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4;
+    std::string path = argc > 3 ? argv[3] : (std::filesystem::temp_directory_path() / "dtpf_bench.conf").string();
+
+    write_config(path, tasks);
+    ConfigStreamOptions options;
+    options.max_in_flight = threads;
+
+    std::printf("%zu tasks, %.1f MB of config, %zu workers\n", tasks,
+                static_cast<double>(std::filesystem::file_size(path)) / (1 << 20), threads);
+    std::printf("%-16s %10s %15s %12s %15s %20s\n", "", "tasks", "first start", "elapsed", "peak memory",
+                "checksum");
+    run_streaming(path, options);
+    run_read_then_run(path, options);
+
+    std::filesystem::remove(path);
+    return 0;
+}
+
+#else
+
+int main() {
+    std::printf("the config stream benchmark requires mmap\n");
+    return 0;
+}
+
+#endif
@@ -0,0 +1,148 @@
+// Concurrent and connection-capped HTTP GETs through the I/O reactor against
+// a loopback server
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "dtpf/io_reactor.hpp"
+#include "dtpf/loopback_http_server.hpp"
+
+#ifdef DTPF_HAS_EPOLL
+#include <sys/resource.h>
+#include <sys/wait.h>
+#endif
+
+using namespace dtpf;
+
+#ifdef DTPF_HAS_EPOLL
+
+namespace {
+
+// Each request holds a socket on both ends, so ask for as many as allowed
+void raise_fd_limit() {
+    rlimit limit{};
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+// The server runs in a child process so client and server sockets count
+// against separate descriptor limits. The child reports its port over a
+// socket pair and exits once the parent closes its end.
+pid_t spawn_server(int& control_fd, std::uint16_t& port) {
+    int pair[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+        return -1;
+    }
+    pid_t child = ::fork();
+    if (child == 0) {
+        ::close(pair[0]);
+        raise_fd_limit();
+        {
+            LoopbackHttpServer server;
+            std::uint16_t bound = server.port();
+            [[maybe_unused]] auto written = ::write(pair[1], &bound, sizeof(bound));
+            char byte;
+            while (::read(pair[1], &byte, 1) > 0) {
+            }
+        }
+        std::_Exit(0);
+    }
+    ::close(pair[1]);
+    control_fd = pair[0];
+    if (::read(control_fd, &port, sizeof(port)) != sizeof(port)) {
+        return -1;
+    }
+    return child;
+}
+
+// Issues every request at once, waits for all of them and prints the
+// timing and how many connections the reactor had to open
+std::uint64_t run_phase(IoReactor& reactor, const std::string& url, size_t requests,
+                        std::optional<HostLimits> limits) {
+    auto before = reactor.stats();
+    std::vector<std::future<HttpResponse>> responses;
+    responses.reserve(requests);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < requests; ++i) {
+        responses.push_back(reactor.get(url, std::chrono::seconds(60), limits));
+    }
+    std::uint64_t failed = 0;
+    for (auto& response : responses) {
+        try {
+            if (response.get().status != 200) {
+                ++failed;
+            }
+        } catch (const std::exception&) {
+            ++failed;
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    auto after = reactor.stats();
+
+    std::printf("elapsed        %10.3f s\n", elapsed.count());
+    std::printf("requests/s     %10.0f\n", static_cast<double>(requests) / elapsed.count());
+    std::printf("opened         %10llu\n",
+                static_cast<unsigned long long>(after.connections_opened - before.connections_opened));
+    std::printf("reused         %10llu\n",
+                static_cast<unsigned long long>(after.connections_reused - before.connections_reused));
+    std::printf("failed         %10llu\n\n", static_cast<unsigned long long>(failed));
+    return failed;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t requests = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    size_t delay_ms = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100;
+    size_t max_in_flight = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 64;
+    raise_fd_limit();
+
+    int control_fd = -1;
+    std::uint16_t port = 0;
+    pid_t child = spawn_server(control_fd, port);
+    if (child < 0) {
+        std::fprintf(stderr, "cannot start server\n");
+        return 1;
+    }
+
+    std::string base = "http://127.0.0.1:" + std::to_string(port);
+    std::uint64_t failed = 0;
+    {
+        IoReactor reactor(1); // one host, so one loop serves it either way
+
+        std::string delayed = base + "/delay/" + std::to_string(delay_ms);
+        std::printf("%zu concurrent GETs of %s\n", requests, delayed.c_str());
+        failed += run_phase(reactor, delayed, requests, std::nullopt);
+
+        // The first phase parked max_idle connections and closed the rest;
+        // under the cap this phase runs on the parked ones
+        HostLimits limits;
+        limits.max_in_flight = max_in_flight;
+        std::string quick = base + "/bytes/64";
+        std::printf("%zu GETs of %s, at most %zu in flight\n", requests, quick.c_str(), max_in_flight);
+        failed += run_phase(reactor, quick, requests, limits);
+    }
+
+    ::close(control_fd);
+    ::waitpid(child, nullptr, 0);
+    return failed == 0 ? 0 : 1;
+}
+
+#else
+
+int main() {
+    std::printf("the network benchmark requires epoll\n");
+    return 0;
+}
+
+#endif
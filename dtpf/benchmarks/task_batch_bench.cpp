@@ -0,0 +1,179 @@
+// Sorting, grouping and scanning many small tasks: pointer lists sorted by
+// comparison and by counting, against columns
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dtpf/counting_sort.hpp"
+#include "dtpf/task_batch.hpp"
+
+using namespace dtpf;
+
+namespace {
+
+// Stand-in for a heap-allocated TaskBase: the sorter reads through virtual calls
+class LightTask {
+public:
+    LightTask(TaskTypeId type, int priority) : type_(type), priority_(priority) {}
+    virtual ~LightTask() = default;
+    virtual TaskTypeId get_type_id() const { return type_; }
+    virtual int get_priority() const { return priority_; }
+
+private:
+    TaskTypeId type_;
+    int priority_;
+};
+
+using TaskList = std::vector<std::unique_ptr<LightTask>>;
+
+template<typename Body>
+double seconds(Body&& body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// TaskSorter's approach on the stand-in tasks: read each key once,
+// counting-sort, move the pointers. tests/task_sorter_test.cpp checks
+// TaskSorter itself against std::stable_sort.
+template<typename Key>
+void counting_sort_tasks(TaskList& tasks, Key&& key) {
+    std::vector<std::uint32_t> keys(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        keys[i] = key(*tasks[i]);
+    }
+    TaskList sorted;
+    sorted.reserve(tasks.size());
+    for (std::uint32_t i : stable_key_order(keys)) {
+        sorted.push_back(std::move(tasks[i]));
+    }
+    tasks = std::move(sorted);
+}
+
+void report(const char* name, double comparison, std::optional<double> counting, double columns) {
+    std::printf("%-18s %9.3f s ", name, comparison);
+    if (counting) {
+        std::printf("%9.3f s ", *counting);
+    } else {
+        std::printf("%11s ", "-");
+    }
+    std::printf("%9.3f s %8.1fx\n", columns, comparison / columns);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10'000'000;
+    constexpr TaskTypeId kTypes = 8;
+    constexpr int kPriorities = 11;
+
+    std::mt19937_64 rng(7);
+    std::vector<std::pair<TaskTypeId, int>> specs(count);
+    for (auto& [type, priority] : specs) {
+        type = static_cast<TaskTypeId>(rng() % kTypes);
+        priority = static_cast<int>(rng() % kPriorities);
+    }
+
+    // Objects are allocated in creation order and then shuffled, as they
+    // would be after a few reorderings
+    TaskList tasks;
+    tasks.reserve(count);
+    for (const auto& [type, priority] : specs) {
+        tasks.push_back(std::make_unique<LightTask>(type, priority));
+    }
+    std::shuffle(tasks.begin(), tasks.end(), rng);
+
+    TaskBatch batch;
+    batch.reserve(count, count * 8);
+    for (size_t i = 0; i < count; ++i) {
+        batch.add(tasks[i]->get_type_id(), tasks[i]->get_priority(), "n=" + std::to_string(i % 1000));
+    }
+
+    std::printf("%zu tasks, %d priorities, %d types\n", count, kPriorities, kTypes);
+    std::printf("%-18s %11s %11s %11s %9s\n", "", "comparison", "counting", "columns", "speedup");
+
+    // Each pointer-list run starts from the same scattered order
+    auto reshuffled = [&](auto body) {
+        std::mt19937_64 order(11);
+        std::shuffle(tasks.begin(), tasks.end(), order);
+        return seconds(body);
+    };
+
+    volatile std::int64_t sink = 0;
+    report("scan priorities",
+        seconds([&] {
+            std::int64_t sum = 0;
+            for (const auto& task : tasks) {
+                sum += task->get_priority();
+            }
+            sink = sum;
+        }),
+        std::nullopt,
+        seconds([&] {
+            std::int64_t sum = 0;
+            for (std::int32_t priority : batch.priorities()) {
+                sum += priority;
+            }
+            sink = sum;
+        }));
+
+    report("sort by priority",
+        reshuffled([&] {
+            std::stable_sort(tasks.begin(), tasks.end(), [](const auto& a, const auto& b) {
+                return a->get_priority() > b->get_priority();
+            });
+        }),
+        reshuffled([&] { counting_sort_tasks(tasks, [](const LightTask& t) { return descending_key(t.get_priority()); }); }),
+        seconds([&] { batch.sort_by_priority(); }));
+
+    report("sort by type",
+        reshuffled([&] {
+            std::stable_sort(tasks.begin(), tasks.end(), [](const auto& a, const auto& b) {
+                return a->get_type_id() < b->get_type_id();
+            });
+        }),
+        reshuffled([&] { counting_sort_tasks(tasks, [](const LightTask& t) { return t.get_type_id(); }); }),
+        seconds([&] { batch.sort_by_type(); }));
+
+    size_t pointer_groups = 0;
+    size_t column_groups = 0;
+    report("group by priority",
+        reshuffled([&] {
+            std::stable_sort(tasks.begin(), tasks.end(), [](const auto& a, const auto& b) {
+                return a->get_priority() > b->get_priority();
+            });
+            for (size_t i = 0; i < tasks.size(); ++i) {
+                pointer_groups += i == 0 || tasks[i]->get_priority() != tasks[i - 1]->get_priority();
+            }
+        }),
+        reshuffled([&] {
+            std::vector<std::uint32_t> keys(tasks.size());
+            for (size_t i = 0; i < tasks.size(); ++i) {
+                keys[i] = descending_key(tasks[i]->get_priority());
+            }
+            auto order = stable_key_order(keys);
+            size_t groups = 0;
+            for (size_t k = 0; k < order.size(); ++k) {
+                groups += k == 0 || keys[order[k]] != keys[order[k - 1]];
+            }
+            sink = static_cast<std::int64_t>(groups);
+        }),
+        seconds([&] {
+            batch.sort_by_priority();
+            column_groups = batch.priority_runs().size();
+        }));
+
+    if (pointer_groups != column_groups) {
+        std::fprintf(stderr, "group counts differ: %zu vs %zu\n", pointer_groups, column_groups);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+// Durable task submissions: one sync per record against group commit across
+// threads, and unsynced appends for reference
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dtpf/task_journal.hpp"
+
+using namespace dtpf;
+
+#ifdef DTPF_HAS_MMAP
+
+namespace {
+
+// Every thread submits its share of records, committing after each one, as
+// the processor does for each completed task
+void run_phase(const char* name, const std::string& path, size_t records, size_t threads, bool sync) {
+    std::filesystem::remove(path);
+    TaskJournalOptions options;
+    options.sync = sync;
+    TaskJournal journal(path, options);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (size_t i = t; i < records; i += threads) {
+                journal.submit("Computation", "algorithm=fibonacci;iterations=" + std::to_string(i));
+                journal.commit();
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    auto stats = journal.stats();
+
+    std::printf("%-26s %9.3f s %12.0f %10llu %10.1f\n", name, elapsed.count(),
+                static_cast<double>(records) / elapsed.count(),
+                static_cast<unsigned long long>(stats.syncs),
+                stats.syncs == 0 ? 0.0 : static_cast<double>(records) / static_cast<double>(stats.syncs));
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t records = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    size_t threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 32;
+    std::string path = argc > 3 ? argv[3]
+                                : (std::filesystem::temp_directory_path() / "dtpf_bench.journal").string();
+
+    std::printf("%zu records to %s\n", records, path.c_str());
+    std::printf("%-26s %11s %12s %10s %10s\n", "", "elapsed", "records/s", "syncs", "per sync");
+    run_phase("sync per record, 1 thread", path, records, 1, true);
+    std::string grouped = "group commit, " + std::to_string(threads) + " threads";
+    run_phase(grouped.c_str(), path, records, threads, true);
+    run_phase("no sync", path, records, 1, false);
+
+    std::filesystem::remove(path);
+    return 0;
+}
+
+#else
+
+int main() {
+    std::printf("the journal benchmark requires mmap\n");
+    return 0;
+}
+
+#endif
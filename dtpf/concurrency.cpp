@@ -12,6 +12,9 @@
 #include <chrono>
 #include <exception>
 #include <stack>
+#include <stdexcept>
+
+#include "dtpf/deadline.hpp"
 
 namespace dtpf {
 
@@ -86,6 +89,32 @@ public:
         }
         
         priority_condition_.notify_one();
+        wake_one_worker();
+        return result;
+    }
+    
+    // Deadline tasks run before priority and regular tasks, earliest deadline first
+    template<typename F, typename... Args>
+    auto enqueue_with_deadline(DeadlineClock::time_point deadline, F&& f, Args&&... args) 
+        -> std::future<std::invoke_result_t<F, Args...>> {
+        
+        using return_type = std::invoke_result_t<F, Args...>;
+        
+        auto task = std::make_shared<std::packaged_task<return_type()>>(
+            std::bind(std::forward<F>(f), std::forward<Args>(args)...)
+        );
+        
+        auto result = task->get_future();
+        
+        {
+            std::lock_guard<std::mutex> lock(priority_queue_mutex_);
+            if (stop_) {
+                throw std::runtime_error("ThreadPool is stopped");
+            }
+            deadline_tasks_.emplace(deadline, deadline_sequence_++, [task] { (*task)(); });
+        }
+        
+        wake_one_worker();
         return result;
     }
     
@@ -119,6 +148,11 @@ public:
         std::lock_guard<std::mutex> lock(priority_queue_mutex_);
         return priority_tasks_.size();
     }
+    
+    size_t deadline_queue_size() const {
+        std::lock_guard<std::mutex> lock(priority_queue_mutex_);
+        return deadline_tasks_.size();
+    }
 
 private:
     struct PriorityTask {
@@ -132,13 +166,38 @@ private:
         }
     };
     
+    struct DeadlineTask {
+        DeadlineClock::time_point deadline;
+        size_t sequence;
+        std::function<void()> task;
+        
+        DeadlineTask(DeadlineClock::time_point d, size_t seq, std::function<void()> t)
+            : deadline(d), sequence(seq), task(std::move(t)) {}
+        
+        bool operator<(const DeadlineTask& other) const {
+            // std::priority_queue is a max-heap: invert so the earliest deadline is on top
+            if (deadline != other.deadline) {
+                return deadline > other.deadline;
+            }
+            return sequence > other.sequence;
+        }
+    };
+    
     void worker_loop() {
         while (true) {
             std::function<void()> task;
             
-            // Try to get priority task first
+            // Try to get deadline and priority tasks first
             {
                 std::unique_lock<std::mutex> lock(priority_queue_mutex_);
+                if (!deadline_tasks_.empty()) {
+                    task = deadline_tasks_.top().task;
+                    deadline_tasks_.pop();
+                    lock.unlock();
+                    
+                    execute_task(task);
+                    continue;
+                }
                 if (!priority_tasks_.empty()) {
                     task = priority_tasks_.top().task;
                     priority_tasks_.pop();
@@ -191,12 +250,25 @@ private:
     
     bool has_priority_tasks() const {
         std::lock_guard<std::mutex> lock(priority_queue_mutex_);
-        return !priority_tasks_.empty();
+        return !priority_tasks_.empty() || !deadline_tasks_.empty();
+    }
+    
+    // Workers sleep on condition_ and check their predicate under queue_mutex_.
+    // Taking and releasing that lock before notifying orders the notify after
+    // any such check, so a worker that just found no work is already waiting
+    // and the wake-up is not lost.
+    void wake_one_worker() {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+        }
+        condition_.notify_one();
     }
     
     std::vector<std::thread> workers_;
     std::queue<std::function<void()>> tasks_;
     std::priority_queue<PriorityTask> priority_tasks_;
+    std::priority_queue<DeadlineTask> deadline_tasks_;
+    size_t deadline_sequence_ = 0;
     
     mutable std::mutex queue_mutex_;
     mutable std::mutex priority_queue_mutex_;
@@ -379,12 +451,14 @@ public:
         RoundRobin,
         Priority,
         LoadBased,
-        WorkStealing
+        WorkStealing,
+        EarliestDeadlineFirst
     };
     
     explicit TaskScheduler(SchedulingPolicy policy = SchedulingPolicy::Priority, 
-                          size_t num_threads = std::thread::hardware_concurrency())
-        : policy_(policy) {
+                          size_t num_threads = std::thread::hardware_concurrency(),
+                          DeadlineAdmission admission = DeadlineAdmission::Demote)
+        : policy_(policy), admission_(admission) {
         
         switch (policy) {
             case SchedulingPolicy::WorkStealing:
@@ -418,6 +492,45 @@ public:
         }
     }
     
+    // Admission check first: a task whose estimated cost no longer fits before
+    // its deadline is rejected (throws) or demoted to best-effort scheduling.
+    template<typename F, typename... Args>
+    auto schedule_deadline_task(DeadlineClock::time_point deadline, DeadlineClock::duration estimated_cost,
+                                F&& f, Args&&... args)
+        -> std::future<std::invoke_result_t<F, Args...>> {
+        
+        auto bound = std::bind(std::forward<F>(f), std::forward<Args>(args)...);
+        
+        if (!can_meet_deadline(deadline, estimated_cost)) {
+            if (admission_ == DeadlineAdmission::Reject) {
+                deadline_metrics_.record_rejected();
+                throw std::runtime_error("Task rejected: deadline cannot be met");
+            }
+            deadline_metrics_.record_demoted();
+            return schedule_task(std::move(bound));
+        }
+        
+        deadline_metrics_.record_admitted();
+        auto tracked = [this, deadline, bound = std::move(bound)]() mutable {
+            // Records met/missed on every exit path, including exceptions
+            struct CompletionRecorder {
+                DeadlineMetrics& metrics;
+                DeadlineClock::time_point deadline;
+                ~CompletionRecorder() { metrics.record_completion(deadline); }
+            } recorder{deadline_metrics_, deadline};
+            return bound();
+        };
+        
+        if (policy_ == SchedulingPolicy::EarliestDeadlineFirst && thread_pool_) {
+            return thread_pool_->enqueue_with_deadline(deadline, std::move(tracked));
+        }
+        return schedule_task(std::move(tracked));
+    }
+    
+    const DeadlineMetrics& deadline_metrics() const {
+        return deadline_metrics_;
+    }
+    
     void shutdown() {
         if (thread_pool_) {
             thread_pool_->shutdown();
@@ -427,6 +540,8 @@ public:
     
 private:
     SchedulingPolicy policy_;
+    DeadlineAdmission admission_;
+    DeadlineMetrics deadline_metrics_;
     std::unique_ptr<ThreadPool> thread_pool_;
     std::unique_ptr<WorkStealingThreadPool> work_stealing_pool_;
 };
@@ -1,38 +1,27 @@
-// Regular expression-based configuration parsing
+// Configuration parsing: a hand-written single-pass parser; routing
+// conditions are matched with regular expressions
 
 #include <regex>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <stdexcept>
-#include <sstream>
-#include <fstream>
-#include <set>
+
+#include "dtpf/config_stream.hpp"
+#include "dtpf/config_syntax.hpp"
+#include "dtpf/task_config.hpp"
 
 namespace dtpf {
 
 // ============================================================================
-// CONFIGURATION PARSER USING REGULAR EXPRESSIONS
+// CONFIGURATION PARSER
 // ============================================================================
 
 class ConfigParser {
 public:
     // Configuration structures
-    struct TaskConfig {
-        std::string type;
-        std::map<std::string, std::string> properties;
-        int priority = 0;
-        std::string node_assignment;
-        
-        bool has_property(const std::string& key) const {
-            return properties.find(key) != properties.end();
-        }
-        
-        std::string get_property(const std::string& key, const std::string& default_value = "") const {
-            auto it = properties.find(key);
-            return (it != properties.end()) ? it->second : default_value;
-        }
-    };
+    using TaskConfig = dtpf::TaskConfig;
     
     struct RoutingRule {
         std::string from_node;
@@ -58,60 +47,65 @@ public:
         std::string execution_policy = "sequential";
     };
 
-private:
-    // Regex pattern getter functions
-    static const std::regex& get_task_pattern() {
-        static const std::regex pattern{R"(task\s*:\s*(\w+)\s*\{([^}]*)\})"};
-        return pattern;
-    }
-    
-    static const std::regex& get_property_pattern() {
-        // Pattern matches: key = "value"
-        static const std::regex pattern("(\\w+)\\s*=\\s*\"([^\"]*)\"");
-        return pattern;
-    }
-    
-    static const std::regex& get_routing_pattern() {
-        static const std::regex pattern{R"(route\s*:\s*(\w+)\s*->\s*(\w+)(?:\s*where\s+(.+))?)"};
-        return pattern;
-    }
+    // Every statement in the config, from one pass
+    struct ParsedConfig {
+        std::vector<TaskConfig> tasks;
+        std::vector<RoutingRule> routes;
+        std::vector<NodeConfig> nodes;
+        std::vector<PipelineConfig> pipelines;
+    };
+
+    // ============================================================================
+    // SINGLE-PASS PARSING: one hand-written lexer and recursive-descent parser
+    // (include/dtpf/config_syntax.hpp) reads every statement in order. Errors
+    // throw ConfigSyntaxError with the line and column of the problem.
+    // ============================================================================
     
-    static const std::regex& get_condition_pattern() {
-        static const std::regex pattern{R"((\w+)\s*([><=!]+)\s*(\w+))"};
-        return pattern;
+    static ParsedConfig parse(std::string_view config) {
+        ParsedConfig parsed;
+        for_each_statement(config, [&](const ConfigStatement& statement) {
+            switch (statement.kind) {
+                case ConfigStatement::Kind::Task:
+                    parsed.tasks.push_back(make_task_config(statement));
+                    break;
+                case ConfigStatement::Kind::Node:
+                    parsed.nodes.push_back(make_node(statement));
+                    break;
+                case ConfigStatement::Kind::Route:
+                    parsed.routes.push_back(make_route(statement));
+                    break;
+                case ConfigStatement::Kind::Pipeline:
+                    parsed.pipelines.push_back(make_pipeline(statement));
+                    break;
+            }
+        });
+        return parsed;
     }
     
-    static const std::regex& get_pipeline_pattern() {
-        static const std::regex pattern{R"(pipeline\s*:\s*(.+))"};
-        return pattern;
+    // Calls visit(const ConfigStatement&) for each statement; the statement's
+    // views are valid only during the call
+    template<typename Visit>
+    static void for_each_statement(std::string_view config, Visit&& visit) {
+        ConfigStatementParser parser(config);
+        ConfigStatement statement;
+        while (parser.next(statement)) {
+            visit(statement);
+        }
     }
     
-    static const std::regex& get_node_pattern() {
-        static const std::regex pattern{R"(node\s*:\s*(\w+)\s*\{([^}]*)\})"};
-        return pattern;
-    }
-
-public:
     // ============================================================================
     // TASK CONFIGURATION PARSING
     // ============================================================================
     
+    // Whole configs only; stream_config_file runs tasks from a file as it
+    // is read
     static std::vector<TaskConfig> parse_tasks(const std::string& config) {
         std::vector<TaskConfig> tasks;
-        const auto& task_pattern = get_task_pattern();
-        std::sregex_iterator iter(config.begin(), config.end(), task_pattern);
-        std::sregex_iterator end;
-        
-        for (; iter != end; ++iter) {
-            TaskConfig task_config;
-            task_config.type = (*iter)[1].str();
-            
-            std::string properties = (*iter)[2].str();
-            parse_properties(properties, task_config);
-            
-            tasks.push_back(std::move(task_config));
-        }
-        
+        for_each_statement(config, [&](const ConfigStatement& statement) {
+            if (statement.kind == ConfigStatement::Kind::Task) {
+                tasks.push_back(make_task_config(statement));
+            }
+        });
         return tasks;
     }
     
@@ -121,25 +115,11 @@ public:
     
     static std::vector<RoutingRule> parse_routing(const std::string& config) {
         std::vector<RoutingRule> rules;
-        const auto& routing_pattern = get_routing_pattern();
-        std::sregex_iterator iter(config.begin(), config.end(), routing_pattern);
-        
-        for (; iter != std::sregex_iterator{}; ++iter) {
-            RoutingRule rule;
-            rule.from_node = (*iter)[1].str();
-            rule.to_node = (*iter)[2].str();
-            
-            if ((*iter)[3].matched) {
-                rule.condition_string = (*iter)[3].str();
-                rule.condition = std::regex(parse_condition_to_regex(rule.condition_string));
-            } else {
-                rule.condition_string = ".*";
-                rule.condition = std::regex(".*"); // Match all
+        for_each_statement(config, [&](const ConfigStatement& statement) {
+            if (statement.kind == ConfigStatement::Kind::Route) {
+                rules.push_back(make_route(statement));
             }
-            
-            rules.push_back(std::move(rule));
-        }
-        
+        });
         return rules;
     }
     
@@ -149,19 +129,11 @@ public:
     
     static std::vector<NodeConfig> parse_nodes(const std::string& config) {
         std::vector<NodeConfig> nodes;
-        const auto& node_pattern = get_node_pattern();
-        std::sregex_iterator iter(config.begin(), config.end(), node_pattern);
-        
-        for (; iter != std::sregex_iterator{}; ++iter) {
-            NodeConfig node_config;
-            node_config.name = (*iter)[1].str();
-            
-            std::string properties = (*iter)[2].str();
-            parse_node_properties(properties, node_config);
-            
-            nodes.push_back(std::move(node_config));
-        }
-        
+        for_each_statement(config, [&](const ConfigStatement& statement) {
+            if (statement.kind == ConfigStatement::Kind::Node) {
+                nodes.push_back(make_node(statement));
+            }
+        });
         return nodes;
     }
     
@@ -171,29 +143,11 @@ public:
     
     static std::vector<PipelineConfig> parse_pipelines(const std::string& config) {
         std::vector<PipelineConfig> pipelines;
-        const auto& pipeline_pattern = get_pipeline_pattern();
-        std::sregex_iterator iter(config.begin(), config.end(), pipeline_pattern);
-        
-        for (; iter != std::sregex_iterator{}; ++iter) {
-            PipelineConfig pipeline_config;
-            std::string stages_str = (*iter)[1].str();
-            
-            // Split stages by '->' 
-            std::regex stage_delimiter{R"(\s*->\s*)"};
-            std::sregex_token_iterator stage_iter(
-                stages_str.begin(), stages_str.end(), stage_delimiter, -1
-            );
-            
-            for (; stage_iter != std::sregex_token_iterator{}; ++stage_iter) {
-                std::string stage = stage_iter->str();
-                if (!stage.empty()) {
-                    pipeline_config.stages.push_back(stage);
-                }
+        for_each_statement(config, [&](const ConfigStatement& statement) {
+            if (statement.kind == ConfigStatement::Kind::Pipeline) {
+                pipelines.push_back(make_pipeline(statement));
             }
-            
-            pipelines.push_back(std::move(pipeline_config));
-        }
-        
+        });
         return pipelines;
     }
     
@@ -203,27 +157,25 @@ public:
     
     static bool validate_config(const std::string& config) {
         try {
-            auto tasks = parse_tasks(config);
-            auto routing = parse_routing(config);
-            auto nodes = parse_nodes(config);
-            
-            // Basic validation
-            return !tasks.empty(); // At least one task required
+            return !parse(config).tasks.empty(); // At least one task required
         } catch (const std::exception&) {
             return false;
         }
     }
     
+    // The text between the braces of the first "<section_name> {...}"
     static std::string extract_section(const std::string& config, const std::string& section_name) {
-        std::regex section_pattern{
-            R"()" + section_name + R"(\s*\{([^}]*)\})"
-        };
-        
-        std::smatch match;
-        if (std::regex_search(config, match, section_pattern)) {
-            return match[1].str();
+        for (size_t at = config.find(section_name); at != std::string::npos && !section_name.empty();
+             at = config.find(section_name, at + 1)) {
+            size_t open = config.find_first_not_of(" \t\r\n", at + section_name.size());
+            if (open == std::string::npos || config[open] != '{') {
+                continue;
+            }
+            size_t close = config.find('}', open + 1);
+            if (close != std::string::npos) {
+                return config.substr(open + 1, close - open - 1);
+            }
         }
-        
         return "";
     }
 
@@ -232,67 +184,49 @@ private:
     // HELPER METHODS
     // ============================================================================
     
-    static void parse_properties(const std::string& properties, TaskConfig& task_config) {
-        const auto& property_pattern = get_property_pattern();
-        std::sregex_iterator prop_iter(properties.begin(), properties.end(), property_pattern);
-        
-        for (; prop_iter != std::sregex_iterator{}; ++prop_iter) {
-            std::string key = (*prop_iter)[1].str();
-            std::string value = (*prop_iter)[2].str();
-            
-            task_config.properties[key] = value;
-            
-            // Handle special properties
-            if (key == "priority") {
-                task_config.priority = std::stoi(value);
-            } else if (key == "node") {
-                task_config.node_assignment = value;
-            }
-        }
-    }
-    
-    static void parse_node_properties(const std::string& properties, NodeConfig& node_config) {
-        const auto& property_pattern = get_property_pattern();
-        std::sregex_iterator prop_iter(properties.begin(), properties.end(), property_pattern);
-        
-        for (; prop_iter != std::sregex_iterator{}; ++prop_iter) {
-            std::string key = (*prop_iter)[1].str();
-            std::string value = (*prop_iter)[2].str();
-            
-            node_config.properties[key] = value;
+    static NodeConfig make_node(const ConfigStatement& statement) {
+        NodeConfig node_config;
+        node_config.name = statement.name;
+        for (size_t i = 0; i < statement.properties.size(); ++i) {
+            auto [key, value] = statement.properties[i];
+            node_config.properties[std::string(key)] = value;
             
             // Handle special properties
             if (key == "address") {
                 node_config.address = value;
             } else if (key == "port") {
-                node_config.port = std::stoi(value);
+                node_config.port = ConfigStatementParser::to_int(statement.values[i], key);
             } else if (key == "max_workers") {
-                node_config.max_workers = std::stoi(value);
+                node_config.max_workers = ConfigStatementParser::to_int(statement.values[i], key);
             }
         }
+        return node_config;
     }
     
-    static std::string parse_condition_to_regex(const std::string& condition) {
-        const auto& condition_pattern = get_condition_pattern();
-        std::smatch match;
-        if (std::regex_match(condition, match, condition_pattern)) {
-            std::string field = match[1].str();
-            std::string op = match[2].str();
-            std::string value = match[3].str();
-            
-            // Convert logical condition to regex pattern
-            if (op == "==" || op == "=") {
-                return field + R"(\s*:\s*)" + value;
-            } else if (op == "!=") {
-                return R"((?!)" + field + R"(\s*:\s*)" + value + R"()).*)";
-            } else if (op == ">") {
-                // For numeric comparisons, this is simplified
-                return field + R"(\s*:\s*[0-9]+)"; // Would need more sophisticated parsing
-            }
+    static RoutingRule make_route(const ConfigStatement& statement) {
+        RoutingRule rule;
+        rule.from_node = statement.from;
+        rule.to_node = statement.to;
+        if (!statement.condition.empty()) {
+            rule.condition_string = statement.condition;
+            rule.condition = std::regex(condition_to_pattern(rule.condition_string));
+        } else {
+            rule.condition_string = ".*";
+            rule.condition = match_all(); // Match all
         }
-        
-        // Default: treat as regex pattern
-        return condition;
+        return rule;
+    }
+    
+    static PipelineConfig make_pipeline(const ConfigStatement& statement) {
+        PipelineConfig pipeline_config;
+        pipeline_config.stages.assign(statement.stages.begin(), statement.stages.end());
+        return pipeline_config;
+    }
+    
+    // Compiled once; routes without a condition copy it
+    static const std::regex& match_all() {
+        static const std::regex pattern(".*");
+        return pattern;
     }
 };
 
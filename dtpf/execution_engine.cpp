@@ -6,19 +6,27 @@
 #include <exception>
 #include <chrono>
 #include <thread>
+#include <atomic>
 #include <iostream>
 #include <algorithm>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <cstdint>
+#include <limits>
+#include <span>
 
-namespace dtpf {
+#include "dtpf/any_result.hpp"
+#include "dtpf/counting_sort.hpp"
+#include "dtpf/deadline.hpp"
+#include "dtpf/event_log.hpp"
+#include "dtpf/result_stream.hpp"
+#include "dtpf/task_base.hpp"
+#include "dtpf/task_batch.hpp"
+#include "dtpf/task_type_registry.hpp"
 
-// Forward declarations
-class TaskBase {
-public:
-    virtual ~TaskBase() = default;
-    virtual std::string execute() = 0;
-    virtual std::string get_type() const = 0;
-    virtual int get_priority() const = 0;
-};
+namespace dtpf {
 
 // ============================================================================
 // EXECUTION POLICIES AND STRATEGIES
@@ -29,7 +37,8 @@ enum class ExecutionStrategy {
     Parallel,
     Pipeline,
     Distributed,
-    Adaptive
+    Adaptive,
+    EarliestDeadline
 };
 
 struct ExecutionPolicy {
@@ -39,6 +48,13 @@ struct ExecutionPolicy {
     bool retry_on_failure = true;
     int max_retries = 3;
     std::vector<std::string> preferred_nodes;
+    size_t result_buffer = 64; // finished results held back when a streaming consumer lags
+    DeadlineAdmission deadline_admission = DeadlineAdmission::Demote;
+    // Grain-size batching: cheap tasks are grouped into chunks sized so that
+    // each chunk runs for roughly target_chunk_time
+    bool adaptive_batching = true;
+    std::chrono::microseconds target_chunk_time{500};
+    size_t batching_threshold = 64; // batch unmeasured workloads at least this large
 };
 
 // ============================================================================
@@ -63,6 +79,19 @@ public:
     
     // Execute tasks based on current strategy
     std::vector<std::string> execute(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
+        std::vector<AnyResult> typed = execute_typed(tasks);
+        
+        // Results leave the engine here, so this is where they become text
+        std::vector<std::string> results;
+        results.reserve(typed.size());
+        for (const auto& result : typed) {
+            results.push_back(result.to_string());
+        }
+        return results;
+    }
+    
+    // Execute tasks and keep each result in its native type
+    std::vector<AnyResult> execute_typed(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
         if (tasks.empty()) {
             return {};
         }
@@ -78,86 +107,382 @@ public:
                 return execute_distributed(tasks);
             case ExecutionStrategy::Adaptive:
                 return execute_adaptive(tasks);
+            case ExecutionStrategy::EarliestDeadline:
+                return execute_earliest_deadline(tasks);
             default:
                 return execute_parallel(tasks);
         }
     }
+    
+    const DeadlineMetrics& deadline_metrics() const {
+        return deadline_metrics_;
+    }
+    
+    // Deliver each result with its task index as soon as the task finishes
+    void execute_streaming(const std::vector<std::unique_ptr<TaskBase>>& tasks,
+                           const ResultCallback& on_result) {
+        execute_streaming_typed(tasks, [&on_result](size_t i, AnyResult result) {
+            on_result(i, result.to_string());
+        });
+    }
+    
+    void execute_streaming_typed(const std::vector<std::unique_ptr<TaskBase>>& tasks,
+                                 const TypedResultCallback& on_result) {
+        if (tasks.empty()) {
+            return;
+        }
+        
+        ExecutionStrategy strategy = policy_.strategy == ExecutionStrategy::Adaptive
+            ? choose_adaptive_strategy(tasks)
+            : policy_.strategy;
+        StreamOptions options{policy_.max_concurrency, policy_.result_buffer};
+        
+        switch (strategy) {
+            case ExecutionStrategy::Sequential:
+                DTPF_EVENT(Info, EventKind::StrategyBegin, tasks.size(), 0, "Streaming sequential");
+                for (size_t i = 0; i < tasks.size(); ++i) {
+                    DTPF_EVENT(Debug, EventKind::TaskStart, i, tasks.size(), task_type_name(tasks[i]->get_type_id()));
+                    on_result(i, run_task(*tasks[i]));
+                }
+                break;
+            case ExecutionStrategy::Pipeline:
+                DTPF_EVENT(Info, EventKind::StrategyBegin, tasks.size(), 0, "Streaming pipeline");
+                for (size_t i = 0; i < tasks.size(); ++i) {
+                    DTPF_EVENT(Debug, EventKind::PipelineStage, i, tasks.size(), task_type_name(tasks[i]->get_type_id()));
+                    try {
+                        on_result(i, tasks[i]->execute_any());
+                    } catch (const std::exception& e) {
+                        on_result(i, AnyResult{"Pipeline error at stage " + std::to_string(i + 1) + ": " + e.what()});
+                        break;
+                    }
+                }
+                break;
+            case ExecutionStrategy::EarliestDeadline:
+                DTPF_EVENT(Info, EventKind::StrategyBegin, tasks.size(), 0, "Streaming earliest-deadline");
+                run_earliest_deadline(tasks, on_result);
+                break;
+            case ExecutionStrategy::Distributed:
+                DTPF_EVENT(Info, EventKind::StrategyBegin, tasks.size(), 0, "Streaming distributed");
+                stream_results(tasks.size(),
+                    [&](size_t i) { return run_on_node(*tasks[i], i, node_for(i)); },
+                    on_result, options);
+                break;
+            default:
+                DTPF_EVENT(Info, EventKind::StrategyBegin, tasks.size(), 0, "Streaming parallel");
+                stream_results(tasks.size(),
+                    [&](size_t i) { return run_task(*tasks[i]); },
+                    on_result, options);
+                break;
+        }
+    }
+    
+    // Runs every row of a columnar batch into the row's result slot.
+    // run_row(TaskTypeId type, std::string_view params) executes one task, and
+    // an exception becomes an "Error: ..." result. Sequential and Pipeline run
+    // the rows in order on this thread. EarliestDeadline sorts the batch by
+    // deadline first. Every other strategy runs grain-sized chunks of rows in
+    // parallel.
+    template<typename RunRow>
+    void execute_batch(TaskBatch& batch, RunRow&& run_row) {
+        if (batch.empty()) {
+            return;
+        }
+        
+        ExecutionStrategy strategy = policy_.strategy == ExecutionStrategy::Adaptive
+            ? choose_adaptive_strategy(profile_of(batch))
+            : policy_.strategy;
+        if (strategy == ExecutionStrategy::EarliestDeadline) {
+            batch.sort_by_deadline();
+        }
+        
+        std::span<AnyResult> results = batch.results();
+        std::span<const TaskTypeId> types = batch.type_ids();
+        auto run = [&](size_t row) {
+            try {
+                results[row] = AnyResult{run_row(types[row], batch.params(row))};
+            } catch (const std::exception& e) {
+                results[row] = AnyResult{std::string("Error: ") + e.what()};
+            }
+        };
+        
+        if (strategy == ExecutionStrategy::Sequential || strategy == ExecutionStrategy::Pipeline) {
+            DTPF_EVENT(Info, EventKind::StrategyBegin, batch.size(), 0, "Sequential batch");
+            for (size_t row = 0; row < batch.size(); ++row) {
+                run(row);
+            }
+            return;
+        }
+        DTPF_EVENT(Info, EventKind::StrategyBegin, batch.size(), 0, "Chunked parallel batch");
+        run_chunked(batch.size(), run, [&](size_t row) { return types[row]; }, mean_estimated_cost(types));
+    }
 
 private:
     ExecutionPolicy policy_;
+    DeadlineMetrics deadline_metrics_;
+    
+    // Exponentially weighted average execution time per task type, used by
+    // deadline admission to predict whether a task can still finish in time
+    std::mutex cost_mutex_;
+    std::vector<std::optional<DeadlineClock::duration>> cost_estimates_; // indexed by TaskTypeId
+    
+    DeadlineClock::duration estimated_cost(TaskTypeId type) {
+        std::lock_guard<std::mutex> lock(cost_mutex_);
+        return type < cost_estimates_.size() && cost_estimates_[type]
+            ? *cost_estimates_[type] : DeadlineClock::duration::zero();
+    }
+    
+    void record_cost(TaskTypeId type, DeadlineClock::duration observed) {
+        std::lock_guard<std::mutex> lock(cost_mutex_);
+        if (type >= cost_estimates_.size()) {
+            cost_estimates_.resize(type + 1);
+        }
+        auto& estimate = cost_estimates_[type];
+        estimate = estimate ? (*estimate * 7 + observed) / 8 : observed;
+    }
+    
+    static AnyResult run_task(TaskBase& task) {
+        try {
+            return task.execute_any();
+        } catch (const std::exception& e) {
+            return AnyResult{std::string("Error: ") + e.what()};
+        }
+    }
+    
+    std::string node_for(size_t i) const {
+        return policy_.preferred_nodes.empty() 
+            ? "node_" + std::to_string(i % 3)  // Round-robin default
+            : policy_.preferred_nodes[i % policy_.preferred_nodes.size()];
+    }
+    
+    // Remote results cross a process boundary, so they travel as text
+    static AnyResult run_on_node(TaskBase& task, size_t i, const std::string& node_id) {
+        try {
+            // Simulate network latency for distributed execution
+            std::this_thread::sleep_for(std::chrono::milliseconds(50 + (i * 10)));
+            
+            std::string result = task.execute();
+            return AnyResult{"[" + node_id + "] " + result};
+        } catch (const std::exception& e) {
+            return AnyResult{"[" + node_id + "] Error: " + std::string(e.what())};
+        }
+    }
     
     // Execute tasks one by one
-    std::vector<std::string> execute_sequential(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
-        std::vector<std::string> results;
+    std::vector<AnyResult> execute_sequential(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
+        std::vector<AnyResult> results;
         results.reserve(tasks.size());
         
-        std::cout << "  → Sequential execution of " << tasks.size() << " tasks\n";
+        DTPF_EVENT(Info, EventKind::StrategyBegin, tasks.size(), 0, "Sequential");
         
         for (size_t i = 0; i < tasks.size(); ++i) {
-            try {
-                std::cout << "    Executing task " << (i + 1) << "/" << tasks.size() 
-                         << " (" << tasks[i]->get_type() << ")\n";
-                results.push_back(tasks[i]->execute());
-            } catch (const std::exception& e) {
-                results.push_back("Error: " + std::string(e.what()));
-            }
+            DTPF_EVENT(Debug, EventKind::TaskStart, i, tasks.size(), task_type_name(tasks[i]->get_type_id()));
+            results.push_back(run_task(*tasks[i]));
         }
         
         return results;
     }
     
     // Execute tasks in parallel using std::async
-    std::vector<std::string> execute_parallel(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
-        std::cout << "  → Parallel execution of " << tasks.size() << " tasks\n";
+    std::vector<AnyResult> execute_parallel(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
+        if (should_batch(tasks)) {
+            return execute_chunked(tasks);
+        }
         
-        std::vector<std::future<std::string>> futures;
+        DTPF_EVENT(Info, EventKind::StrategyBegin, tasks.size(), 0, "Parallel");
+        
+        std::vector<std::future<AnyResult>> futures;
         futures.reserve(tasks.size());
         
         // Launch all tasks asynchronously
         for (size_t i = 0; i < tasks.size(); ++i) {
             futures.push_back(
-                std::async(std::launch::async, [&tasks, i]() {
-                    try {
-                        return tasks[i]->execute();
-                    } catch (const std::exception& e) {
-                        return std::string("Error: ") + e.what();
-                    }
+                std::async(std::launch::async, [this, &tasks, i]() {
+                    auto started = DeadlineClock::now();
+                    AnyResult result = run_task(*tasks[i]);
+                    record_cost(tasks[i]->get_type_id(), DeadlineClock::now() - started);
+                    return result;
                 })
             );
         }
         
         // Collect results
-        std::vector<std::string> results;
+        std::vector<AnyResult> results;
         results.reserve(futures.size());
         
         for (size_t i = 0; i < futures.size(); ++i) {
-            std::cout << "    Waiting for task " << (i + 1) << "/" << futures.size() << "\n";
+            DTPF_EVENT(Debug, EventKind::TaskWait, i, futures.size());
             results.push_back(futures[i].get());
         }
         
         return results;
     }
     
+    // ========================================================================
+    // GRAIN-SIZE BATCHING
+    // ========================================================================
+    
+    // Batch when the measured mean cost is well below the chunk window, or when
+    // nothing is known yet and the batch is too large for a future per task
+    bool should_batch(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
+        if (!policy_.adaptive_batching || tasks.size() <= std::max<size_t>(policy_.max_concurrency, 1)) {
+            return false;
+        }
+        
+        auto mean = mean_estimated_cost(tasks);
+        if (!mean) {
+            return tasks.size() >= policy_.batching_threshold;
+        }
+        return *mean * 2 < policy_.target_chunk_time;
+    }
+    
+    std::optional<DeadlineClock::duration> mean_estimated_cost(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
+        std::lock_guard<std::mutex> lock(cost_mutex_);
+        DeadlineClock::duration total{0};
+        for (const auto& task : tasks) {
+            TaskTypeId type = task->get_type_id();
+            if (type >= cost_estimates_.size() || !cost_estimates_[type]) {
+                return std::nullopt;
+            }
+            total += *cost_estimates_[type];
+        }
+        return total / static_cast<DeadlineClock::rep>(tasks.size());
+    }
+    
+    std::optional<DeadlineClock::duration> mean_estimated_cost(std::span<const TaskTypeId> types) {
+        std::lock_guard<std::mutex> lock(cost_mutex_);
+        DeadlineClock::duration total{0};
+        for (TaskTypeId type : types) {
+            if (type >= cost_estimates_.size() || !cost_estimates_[type]) {
+                return std::nullopt;
+            }
+            total += *cost_estimates_[type];
+        }
+        return total / static_cast<DeadlineClock::rep>(types.size());
+    }
+    
+    // Workers claim contiguous index ranges from a shared cursor and write each
+    // result straight into its task's slot. After every chunk a worker re-sizes
+    // its next claim from the measured per-task time, capped so that the tail
+    // of the batch still spreads across all workers.
+    std::vector<AnyResult> execute_chunked(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
+        DTPF_EVENT(Info, EventKind::StrategyBegin, tasks.size(), 0, "Chunked parallel");
+        
+        std::vector<AnyResult> results(tasks.size());
+        run_chunked(tasks.size(),
+            [&](size_t i) { results[i] = run_task(*tasks[i]); },
+            [&](size_t i) { return tasks[i]->get_type_id(); },
+            mean_estimated_cost(tasks));
+        return results;
+    }
+    
+    // run(i) executes task i; type_of(i) names its type for cost tracking
+    template<typename Run, typename TypeOf>
+    void run_chunked(size_t task_count, Run&& run, TypeOf&& type_of,
+                     std::optional<DeadlineClock::duration> initial_estimate) {
+        const size_t worker_count = std::clamp<size_t>(policy_.max_concurrency, 1, task_count);
+        const auto target = std::chrono::duration_cast<DeadlineClock::duration>(policy_.target_chunk_time);
+        
+        auto chunk_for = [&](DeadlineClock::duration per_task, size_t remaining) -> size_t {
+            size_t balanced = std::max<size_t>(remaining / (worker_count * 4), 1);
+            if (per_task <= DeadlineClock::duration::zero()) {
+                return balanced;
+            }
+            auto fitting = static_cast<size_t>(target / per_task);
+            return std::clamp<size_t>(fitting, 1, balanced);
+        };
+        
+        std::atomic<size_t> cursor{0};
+        
+        // Time spent on each type within one chunk
+        struct TypeCost {
+            TaskTypeId type;
+            DeadlineClock::duration total{0};
+            size_t count = 0;
+        };
+        
+        auto worker = [&] {
+            // Unmeasured workloads start with single-task probes
+            size_t chunk = initial_estimate ? chunk_for(*initial_estimate, task_count) : 1;
+            std::vector<TypeCost> costs;
+            while (true) {
+                size_t begin = cursor.fetch_add(chunk, std::memory_order_relaxed);
+                if (begin >= task_count) {
+                    return;
+                }
+                size_t end = std::min(begin + chunk, task_count);
+                
+                // Each run of same-type tasks is timed as one span and charged
+                // to that type, so mixed lists keep per-type costs apart while
+                // a single-type chunk still reads the clock only twice
+                costs.clear();
+                auto charge = [&](TaskTypeId type, DeadlineClock::duration spent, size_t count) {
+                    auto it = std::find_if(costs.begin(), costs.end(),
+                                           [type](const TypeCost& cost) { return cost.type == type; });
+                    if (it == costs.end()) {
+                        costs.push_back(TypeCost{type});
+                        it = std::prev(costs.end());
+                    }
+                    it->total += spent;
+                    it->count += count;
+                };
+                auto started = DeadlineClock::now();
+                auto span_start = started;
+                size_t span_begin = begin;
+                TaskTypeId span_type = type_of(begin);
+                for (size_t i = begin; i < end; ++i) {
+                    TaskTypeId type = type_of(i);
+                    if (type != span_type) {
+                        auto now = DeadlineClock::now();
+                        charge(span_type, now - span_start, i - span_begin);
+                        span_start = now;
+                        span_begin = i;
+                        span_type = type;
+                    }
+                    run(i);
+                }
+                auto finished = DeadlineClock::now();
+                charge(span_type, finished - span_start, end - span_begin);
+                for (const auto& cost : costs) {
+                    record_cost(cost.type, cost.total / static_cast<DeadlineClock::rep>(cost.count));
+                }
+                auto per_task = (finished - started) / static_cast<DeadlineClock::rep>(end - begin);
+                DTPF_EVENT(Trace, EventKind::Message, begin, end, "chunk complete");
+                
+                size_t claimed = std::min(cursor.load(std::memory_order_relaxed), task_count);
+                chunk = chunk_for(per_task, task_count - claimed);
+            }
+        };
+        
+        std::vector<std::thread> workers;
+        workers.reserve(worker_count);
+        for (size_t w = 0; w < worker_count; ++w) {
+            workers.emplace_back(worker);
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+    
     // Execute tasks as pipeline (output of one feeds into next)
-    std::vector<std::string> execute_pipeline(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
-        std::cout << "  → Pipeline execution of " << tasks.size() << " tasks\n";
+    std::vector<AnyResult> execute_pipeline(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
+        DTPF_EVENT(Info, EventKind::StrategyBegin, tasks.size(), 0, "Pipeline");
         
-        std::vector<std::string> results;
-        std::string pipeline_input = "initial_input";
+        std::vector<AnyResult> results;
+        results.reserve(tasks.size());
+        AnyResult initial_input{std::string("initial_input")};
+        [[maybe_unused]] const AnyResult* pipeline_input = &initial_input;
         
         for (size_t i = 0; i < tasks.size(); ++i) {
             try {
-                std::cout << "    Pipeline stage " << (i + 1) << "/" << tasks.size() 
-                         << " (" << tasks[i]->get_type() << ")\n";
+                DTPF_EVENT(Debug, EventKind::PipelineStage, i, tasks.size(), task_type_name(tasks[i]->get_type_id()));
                 
                 // In a real pipeline, you'd pass pipeline_input to the task
                 // For demonstration, we'll just execute each task
-                std::string result = tasks[i]->execute();
-                results.push_back(result);
-                pipeline_input = result; // Use result as input for next task
+                results.push_back(tasks[i]->execute_any());
+                pipeline_input = &results.back(); // Typed result feeds the next stage as-is
             } catch (const std::exception& e) {
                 std::string error = "Pipeline error at stage " + std::to_string(i + 1) + ": " + e.what();
-                results.push_back(error);
+                results.push_back(AnyResult{std::move(error)});
                 break; // Stop pipeline on error
             }
         }
@@ -166,105 +491,289 @@ private:
     }
     
     // Simulate distributed execution
-    std::vector<std::string> execute_distributed(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
-        std::cout << "  → Distributed execution of " << tasks.size() << " tasks across nodes\n";
+    std::vector<AnyResult> execute_distributed(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
+        DTPF_EVENT(Info, EventKind::StrategyBegin, tasks.size(), 0, "Distributed");
         
-        std::vector<std::future<std::string>> distributed_futures;
+        std::vector<std::future<AnyResult>> distributed_futures;
         distributed_futures.reserve(tasks.size());
         
         for (size_t i = 0; i < tasks.size(); ++i) {
-            std::string node_id = policy_.preferred_nodes.empty() 
-                ? "node_" + std::to_string(i % 3)  // Round-robin default
-                : policy_.preferred_nodes[i % policy_.preferred_nodes.size()];
+            std::string node_id = node_for(i);
             
-            std::cout << "    Assigning task " << (i + 1) << " to " << node_id << "\n";
+            DTPF_EVENT(Debug, EventKind::TaskAssign, i, 0, node_id);
             
             // Simulate distributed execution with additional latency
             distributed_futures.push_back(
                 std::async(std::launch::async, [&tasks, i, node_id]() {
-                    try {
-                        // Simulate network latency for distributed execution
-                        std::this_thread::sleep_for(std::chrono::milliseconds(50 + (i * 10)));
-                        
-                        std::string result = tasks[i]->execute();
-                        return "[" + node_id + "] " + result;
-                    } catch (const std::exception& e) {
-                        return "[" + node_id + "] Error: " + std::string(e.what());
-                    }
+                    return run_on_node(*tasks[i], i, node_id);
                 })
             );
         }
         
         // Collect distributed results
-        std::vector<std::string> results;
+        std::vector<AnyResult> results;
         results.reserve(distributed_futures.size());
         
         for (size_t i = 0; i < distributed_futures.size(); ++i) {
-            std::cout << "    Collecting result from distributed task " << (i + 1) << "\n";
+            DTPF_EVENT(Debug, EventKind::TaskCollect, i);
             results.push_back(distributed_futures[i].get());
         }
         
         return results;
     }
     
+    // Earliest-deadline-first over a fixed set of workers
+    std::vector<AnyResult> execute_earliest_deadline(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
+        DTPF_EVENT(Info, EventKind::StrategyBegin, tasks.size(), 0, "Earliest-deadline");
+        
+        std::vector<AnyResult> results(tasks.size());
+        run_earliest_deadline(tasks, [&results](size_t i, AnyResult result) {
+            results[i] = std::move(result);
+        });
+        return results;
+    }
+    
+    // Deadline-bearing tasks are dispatched in deadline order ahead of batch
+    // work. Before each dispatch the task's predicted cost is checked against
+    // its remaining budget; a task that cannot make it is rejected or demoted
+    // to the batch queue according to policy. on_result calls are serialized
+    // and never made under the queue lock. The first exception from on_result
+    // stops the workers and is rethrown once they are joined.
+    void run_earliest_deadline(const std::vector<std::unique_ptr<TaskBase>>& tasks,
+                               const TypedResultCallback& on_result) {
+        auto batch_start = DeadlineClock::now();
+        
+        struct Entry {
+            size_t index;
+            DeadlineClock::time_point deadline;
+        };
+        std::vector<Entry> deadline_queue;
+        std::deque<size_t> batch_queue;
+        
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            auto budget = tasks[i]->get_deadline();
+            if (budget > std::chrono::milliseconds::zero()) {
+                deadline_queue.push_back({i, batch_start + budget});
+            } else {
+                batch_queue.push_back(i);
+            }
+        }
+        
+        std::stable_sort(deadline_queue.begin(), deadline_queue.end(),
+            [](const Entry& a, const Entry& b) { return a.deadline < b.deadline; });
+        std::stable_sort(batch_queue.begin(), batch_queue.end(),
+            [&tasks](size_t a, size_t b) { return tasks[a]->get_priority() > tasks[b]->get_priority(); });
+        
+        std::mutex queue_mutex;
+        std::mutex result_mutex;
+        size_t next_deadline = 0;
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+        
+        auto fail = [&] {
+            std::lock_guard<std::mutex> lock(result_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            failed = true;
+        };
+        
+        auto deliver = [&](size_t i, AnyResult result) {
+            std::lock_guard<std::mutex> lock(result_mutex);
+            if (!error) {
+                on_result(i, std::move(result));
+            }
+        };
+        
+        auto worker = [&] {
+            while (!failed) {
+                std::optional<Entry> entry;
+                std::optional<size_t> batch_index;
+                std::vector<size_t> rejected;
+                {
+                    std::lock_guard<std::mutex> lock(queue_mutex);
+                    while (next_deadline < deadline_queue.size() && !entry) {
+                        Entry candidate = deadline_queue[next_deadline++];
+                        auto cost = estimated_cost(tasks[candidate.index]->get_type_id());
+                        if (can_meet_deadline(candidate.deadline, cost)) {
+                            entry = candidate;
+                        } else if (policy_.deadline_admission == DeadlineAdmission::Demote) {
+                            deadline_metrics_.record_demoted();
+                            batch_queue.push_back(candidate.index);
+                        } else {
+                            deadline_metrics_.record_rejected();
+                            rejected.push_back(candidate.index);
+                        }
+                    }
+                    if (!entry && !batch_queue.empty()) {
+                        batch_index = batch_queue.front();
+                        batch_queue.pop_front();
+                    }
+                }
+                for (size_t r : rejected) {
+                    deliver(r, AnyResult{std::string("Rejected: deadline cannot be met")});
+                }
+                if (!entry && !batch_index) {
+                    return;
+                }
+                
+                size_t i = entry ? entry->index : *batch_index;
+                if (entry) {
+                    deadline_metrics_.record_admitted();
+                }
+                
+                DTPF_EVENT(Debug, EventKind::TaskStart, i, tasks.size(), task_type_name(tasks[i]->get_type_id()));
+                auto started = DeadlineClock::now();
+                AnyResult result = run_task(*tasks[i]);
+                record_cost(tasks[i]->get_type_id(), DeadlineClock::now() - started);
+                
+                if (entry) {
+                    deadline_metrics_.record_completion(entry->deadline);
+                }
+                deliver(i, std::move(result));
+            }
+        };
+        
+        size_t worker_count = std::clamp<size_t>(policy_.max_concurrency, 1, tasks.size());
+        std::vector<std::thread> workers;
+        workers.reserve(worker_count);
+        for (size_t w = 0; w < worker_count; ++w) {
+            workers.emplace_back([&] {
+                try {
+                    worker();
+                } catch (...) {
+                    fail();
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    
     // Adaptive execution chooses strategy based on task characteristics
-    std::vector<std::string> execute_adaptive(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
-        std::cout << "  → Adaptive execution analyzing " << tasks.size() << " tasks...\n";
+    std::vector<AnyResult> execute_adaptive(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
+        DTPF_EVENT(Info, EventKind::StrategyBegin, tasks.size(), 0, "Adaptive");
+        
+        ExecutionStrategy chosen_strategy = choose_adaptive_strategy(tasks);
+        
+        // Temporarily change strategy and execute
+        ExecutionStrategy original_strategy = policy_.strategy;
+        policy_.strategy = chosen_strategy;
+        
+        std::vector<AnyResult> results = execute_typed(tasks);
+        
+        // Restore original strategy
+        policy_.strategy = original_strategy;
         
-        // Analyze task characteristics
+        return results;
+    }
+    
+    // Task characteristics the adaptive strategy looks at
+    struct WorkloadProfile {
+        size_t total_tasks = 0;
         bool has_high_priority = false;
         bool has_computation_tasks = false;
-        size_t total_tasks = tasks.size();
-        int avg_priority = 0;
+        bool has_deadlines = false;
+        std::int64_t avg_priority = 0;
+    };
+    
+    static WorkloadProfile profile_of(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
+        WorkloadProfile profile;
+        profile.total_tasks = tasks.size();
+        const TaskTypeId computation = task_type_id<"Computation">();
         
         for (const auto& task : tasks) {
             int priority = task->get_priority();
-            avg_priority += priority;
+            profile.avg_priority += priority;
             
             if (priority > 7) {
-                has_high_priority = true;
+                profile.has_high_priority = true;
             }
             
-            if (task->get_type() == "Computation") {
-                has_computation_tasks = true;
+            if (task->get_type_id() == computation) {
+                profile.has_computation_tasks = true;
+            }
+            
+            if (task->get_deadline() > std::chrono::milliseconds::zero()) {
+                profile.has_deadlines = true;
             }
         }
         
-        avg_priority /= static_cast<int>(total_tasks);
+        profile.avg_priority /= static_cast<std::int64_t>(profile.total_tasks);
+        return profile;
+    }
+    
+    // Same profile from the batch's columns: one branch-free pass per column
+    static WorkloadProfile profile_of(const TaskBatch& batch) {
+        WorkloadProfile profile;
+        profile.total_tasks = batch.size();
+        const TaskTypeId computation = task_type_id<"Computation">();
+        
+        std::int64_t priority_sum = 0;
+        std::int32_t max_priority = std::numeric_limits<std::int32_t>::min();
+        for (std::int32_t priority : batch.priorities()) {
+            priority_sum += priority;
+            max_priority = std::max(max_priority, priority);
+        }
+        size_t computation_count = 0;
+        for (TaskTypeId type : batch.type_ids()) {
+            computation_count += type == computation;
+        }
+        std::chrono::milliseconds max_deadline = std::chrono::milliseconds::zero();
+        for (auto deadline : batch.deadlines()) {
+            max_deadline = std::max(max_deadline, deadline);
+        }
+        
+        profile.has_high_priority = max_priority > 7;
+        profile.has_computation_tasks = computation_count > 0;
+        profile.has_deadlines = max_deadline > std::chrono::milliseconds::zero();
+        profile.avg_priority = priority_sum / static_cast<std::int64_t>(profile.total_tasks);
+        return profile;
+    }
+    
+    ExecutionStrategy choose_adaptive_strategy(const std::vector<std::unique_ptr<TaskBase>>& tasks) const {
+        return choose_adaptive_strategy(profile_of(tasks));
+    }
+    
+    ExecutionStrategy choose_adaptive_strategy(const WorkloadProfile& profile) const {
+        const size_t total_tasks = profile.total_tasks;
+        const bool has_high_priority = profile.has_high_priority;
+        const bool has_computation_tasks = profile.has_computation_tasks;
+        const bool has_deadlines = profile.has_deadlines;
+        const std::int64_t avg_priority = profile.avg_priority;
         
         // Choose strategy based on analysis
         ExecutionStrategy chosen_strategy;
         
         if (total_tasks == 1) {
             chosen_strategy = ExecutionStrategy::Sequential;
-            std::cout << "    Adaptive choice: Sequential (single task)\n";
+            DTPF_EVENT(Info, EventKind::StrategyChoice, 0, 0, "Sequential (single task)");
+        } else if (has_deadlines) {
+            chosen_strategy = ExecutionStrategy::EarliestDeadline;
+            DTPF_EVENT(Info, EventKind::StrategyChoice, 0, 0, "EarliestDeadline (latency SLOs)");
         } else if (has_computation_tasks && total_tasks > 2) {
             chosen_strategy = ExecutionStrategy::Parallel;
-            std::cout << "    Adaptive choice: Parallel (computation-heavy tasks)\n";
+            DTPF_EVENT(Info, EventKind::StrategyChoice, 0, 0, "Parallel (computation-heavy tasks)");
         } else if (has_high_priority) {
             chosen_strategy = ExecutionStrategy::Parallel;
-            std::cout << "    Adaptive choice: Parallel (high-priority tasks)\n";
+            DTPF_EVENT(Info, EventKind::StrategyChoice, 0, 0, "Parallel (high-priority tasks)");
         } else if (total_tasks > 5 && !policy_.preferred_nodes.empty()) {
             chosen_strategy = ExecutionStrategy::Distributed;
-            std::cout << "    Adaptive choice: Distributed (large task set with nodes)\n";
+            DTPF_EVENT(Info, EventKind::StrategyChoice, 0, 0, "Distributed (large task set with nodes)");
         } else if (avg_priority < 5) {
             chosen_strategy = ExecutionStrategy::Pipeline;
-            std::cout << "    Adaptive choice: Pipeline (low-priority sequential tasks)\n";
+            DTPF_EVENT(Info, EventKind::StrategyChoice, 0, 0, "Pipeline (low-priority sequential tasks)");
         } else {
             chosen_strategy = ExecutionStrategy::Parallel;
-            std::cout << "    Adaptive choice: Parallel (default)\n";
+            DTPF_EVENT(Info, EventKind::StrategyChoice, 0, 0, "Parallel (default)");
         }
         
-        // Temporarily change strategy and execute
-        ExecutionStrategy original_strategy = policy_.strategy;
-        policy_.strategy = chosen_strategy;
-        
-        std::vector<std::string> results = execute(tasks);
-        
-        // Restore original strategy
-        policy_.strategy = original_strategy;
-        
-        return results;
+        return chosen_strategy;
     }
 };
 
@@ -295,61 +804,112 @@ private:
 // TASK PRIORITIZATION AND SORTING
 // ============================================================================
 
+// Sorts read each task's key once into a flat array and counting-sort it,
+// so they take linear time, are stable and split large inputs across threads
+
 class TaskSorter {
 public:
     static void sort_by_priority(std::vector<std::unique_ptr<TaskBase>>& tasks, bool descending = true) {
-        std::sort(tasks.begin(), tasks.end(), 
-            [descending](const std::unique_ptr<TaskBase>& a, const std::unique_ptr<TaskBase>& b) {
-                if (descending) {
-                    return a->get_priority() > b->get_priority();
-                } else {
-                    return a->get_priority() < b->get_priority();
-                }
-            });
+        auto keys = priority_keys(tasks, descending);
+        apply_order(tasks, stable_key_order(keys));
     }
     
+    // Orders by type name; names are ranked once, tasks sort by rank
     static void sort_by_type(std::vector<std::unique_ptr<TaskBase>>& tasks) {
-        std::sort(tasks.begin(), tasks.end(),
-            [](const std::unique_ptr<TaskBase>& a, const std::unique_ptr<TaskBase>& b) {
-                return a->get_type() < b->get_type();
-            });
+        std::vector<std::uint32_t> keys(tasks.size());
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            keys[i] = tasks[i]->get_type_id(); // interns types seen for the first time
+        }
+        auto ranks = type_name_ranks();
+        for (auto& key : keys) {
+            key = static_cast<std::uint32_t>(ranks[key]);
+        }
+        apply_order(tasks, stable_key_order(keys));
+    }
+    
+    // Columnar overloads: the sort keys come from the batch's dense arrays
+    // and only the fixed-size columns move
+    static void sort_by_priority(TaskBatch& batch, bool descending = true) {
+        batch.sort_by_priority(descending);
     }
     
+    static void sort_by_type(TaskBatch& batch) {
+        batch.sort_by_type(type_name_ranks());
+    }
+    
+    // Sorts the batch and returns one row range per priority, highest first
+    static std::vector<TaskBatch::RowRange> group_by_priority(TaskBatch& batch) {
+        batch.sort_by_priority();
+        return batch.priority_runs();
+    }
+    
+    static std::vector<TaskBatch::RowRange> group_by_type(TaskBatch& batch) {
+        sort_by_type(batch);
+        return batch.type_runs();
+    }
+    
+    // Alphabetical position of every registered type, indexed by TaskTypeId
+    static std::vector<size_t> type_name_ranks() {
+        auto& registry = TaskTypeRegistry::instance();
+        std::vector<TaskTypeId> ids(registry.size());
+        for (size_t id = 0; id < ids.size(); ++id) {
+            ids[id] = static_cast<TaskTypeId>(id);
+        }
+        std::sort(ids.begin(), ids.end(), [&registry](TaskTypeId a, TaskTypeId b) {
+            return registry.name(a) < registry.name(b);
+        });
+        std::vector<size_t> ranks(ids.size());
+        for (size_t rank = 0; rank < ids.size(); ++rank) {
+            ranks[ids[rank]] = rank;
+        }
+        return ranks;
+    }
+    
+    // Highest priority first. Tasks move straight from the input into
+    // groups sized up front. The input is left empty.
     static std::vector<std::vector<std::unique_ptr<TaskBase>>> group_by_priority(
         std::vector<std::unique_ptr<TaskBase>>& tasks) {
         
-        // Sort by priority first
-        sort_by_priority(tasks);
+        auto keys = priority_keys(tasks, true);
+        auto order = stable_key_order(keys);
         
         std::vector<std::vector<std::unique_ptr<TaskBase>>> groups;
-        
-        if (tasks.empty()) {
-            return groups;
-        }
-        
-        int current_priority = tasks[0]->get_priority();
-        std::vector<std::unique_ptr<TaskBase>> current_group;
-        
-        for (auto& task : tasks) {
-            if (task->get_priority() != current_priority) {
-                if (!current_group.empty()) {
-                    groups.push_back(std::move(current_group));
-                    current_group.clear();
-                }
-                current_priority = task->get_priority();
+        for (size_t begin = 0; begin < order.size();) {
+            size_t end = begin + 1;
+            while (end < order.size() && keys[order[end]] == keys[order[begin]]) {
+                ++end;
             }
-            current_group.push_back(std::move(task));
-        }
-        
-        if (!current_group.empty()) {
-            groups.push_back(std::move(current_group));
+            auto& group = groups.emplace_back();
+            group.reserve(end - begin);
+            for (size_t k = begin; k < end; ++k) {
+                group.push_back(std::move(tasks[order[k]]));
+            }
+            begin = end;
         }
         
-        // Clear original vector since we moved all tasks
         tasks.clear();
-        
         return groups;
     }
+    
+private:
+    static std::vector<std::uint32_t> priority_keys(const std::vector<std::unique_ptr<TaskBase>>& tasks,
+                                                    bool descending) {
+        std::vector<std::uint32_t> keys(tasks.size());
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            int priority = tasks[i]->get_priority();
+            keys[i] = descending ? descending_key(priority) : ascending_key(priority);
+        }
+        return keys;
+    }
+    
+    static void apply_order(std::vector<std::unique_ptr<TaskBase>>& tasks, const std::vector<std::uint32_t>& order) {
+        std::vector<std::unique_ptr<TaskBase>> sorted;
+        sorted.reserve(tasks.size());
+        for (std::uint32_t i : order) {
+            sorted.push_back(std::move(tasks[i]));
+        }
+        tasks = std::move(sorted);
+    }
 };
 
 }
\ No newline at end of file
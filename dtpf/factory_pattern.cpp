@@ -1,42 +1,27 @@
 // Task base classes and factory implementation
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <map>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <optional>
 #include <functional>
+#include <future>
 #include <stdexcept>
 
-namespace dtpf {
-
-// Forward declarations from meta_programming.cpp
-template<typename T>
-concept TaskResult = requires(T t) {
-    { t.serialize() } -> std::convertible_to<std::string>;
-    { T::deserialize(std::string{}) } -> std::same_as<T>;
-    std::movable<T>;
-};
+#include "dtpf/any_result.hpp"
+#include "dtpf/perfect_hash.hpp"
+#include "dtpf/task_base.hpp"
+#include "dtpf/task_config.hpp"
+#include "dtpf/task_type_registry.hpp"
 
-// ============================================================================
-// TASK BASE CLASSES
-// ============================================================================
-
-class TaskBase {
-public:
-    virtual ~TaskBase() = default;
-    virtual std::string execute() = 0;
-    virtual std::string get_type() const = 0;
-    virtual int get_priority() const = 0;
-};
-
-template<TaskResult R>
-class Task : public TaskBase {
-public:
-    virtual R execute_typed() = 0;
-    
-    std::string execute() override {
-        return execute_typed().serialize();
-    }
-};
+namespace dtpf {
 
 // ============================================================================
 // FACTORY PATTERN IMPLEMENTATION
@@ -44,34 +29,93 @@ public:
 
 class TaskFactory {
 public:
-    using TaskCreator = std::function<std::unique_ptr<TaskBase>(const std::string&)>;
+    using TaskCreator = std::unique_ptr<TaskBase> (*)(const std::string& config);
     
     template<typename T>
     void register_task(const std::string& type_name) {
         static_assert(std::is_base_of_v<TaskBase, T>, "T must inherit from TaskBase");
         
-        creators_[type_name] = [](const std::string& config) -> std::unique_ptr<TaskBase> {
-            return std::make_unique<T>(T::from_config(config));
-        };
+        std::lock_guard<std::mutex> lock(registration_mutex_);
+        TaskTypeId id = TaskTypeRegistry::instance().intern(type_name);
+        TaskCreator creator = &create<T>;
+        if (id < creators_.size() && creators_[id] == creator) {
+            return;
+        }
+        if (frozen()) {
+            throw std::runtime_error("Task factory is frozen, cannot register: " + type_name);
+        }
+        if (id >= creators_.size()) {
+            creators_.resize(id + 1);
+        }
+        creators_[id] = creator;
+    }
+    
+    // Ends registration (REGISTER_TASK runs before main) and builds the
+    // perfect-hashed lookup table; the first create call freezes implicitly
+    void freeze() {
+        std::lock_guard<std::mutex> lock(registration_mutex_);
+        if (frozen()) {
+            return;
+        }
+        std::vector<std::pair<std::string, TaskCreator>> entries;
+        for (size_t id = 0; id < creators_.size(); ++id) {
+            if (creators_[id]) {
+                entries.push_back({task_type_name(static_cast<TaskTypeId>(id)), creators_[id]});
+            }
+        }
+        lookup_ = PerfectHashMap<TaskCreator>(std::move(entries));
+        frozen_.store(true, std::memory_order_release);
+    }
+    
+    bool frozen() const {
+        return frozen_.load(std::memory_order_acquire);
     }
     
     std::unique_ptr<TaskBase> create_task(const std::string& type, const std::string& config) {
-        auto it = creators_.find(type);
-        if (it != creators_.end()) {
-            return it->second(config);
+        return find_creator(type)(config);
+    }
+    
+    std::unique_ptr<TaskBase> create_task(TaskTypeId type, const std::string& config) {
+        if (!frozen()) {
+            freeze();
+        }
+        if (is_registered(type)) {
+            return creators_[type](config);
+        }
+        throw std::runtime_error("Unknown task type: " + task_type_name(type));
+    }
+    
+    // Builds one task per config directly into the caller's storage
+    void create_tasks(std::span<const TaskConfig> configs, std::span<std::unique_ptr<TaskBase>> out) {
+        if (out.size() < configs.size()) {
+            throw std::invalid_argument("Output storage is smaller than the config list");
+        }
+        std::string parameters;
+        for (size_t i = 0; i < configs.size(); ++i) {
+            TaskCreator creator = find_creator(configs[i].type);
+            parameters.clear();
+            configs[i].append_parameters(parameters);
+            out[i] = creator(parameters);
         }
-        throw std::runtime_error("Unknown task type: " + type);
     }
     
     bool is_registered(const std::string& type) const {
-        return creators_.find(type) != creators_.end();
+        auto id = TaskTypeRegistry::instance().find(type);
+        return id && is_registered(*id);
+    }
+    
+    bool is_registered(TaskTypeId type) const {
+        return type < creators_.size() && creators_[type];
     }
     
     std::vector<std::string> get_registered_types() const {
         std::vector<std::string> types;
-        for (const auto& [type, _] : creators_) {
-            types.push_back(type);
+        for (size_t id = 0; id < creators_.size(); ++id) {
+            if (creators_[id]) {
+                types.push_back(task_type_name(static_cast<TaskTypeId>(id)));
+            }
         }
+        std::sort(types.begin(), types.end());
         return types;
     }
     
@@ -82,7 +126,26 @@ public:
     
 private:
     TaskFactory() = default;
-    std::map<std::string, TaskCreator> creators_;
+    
+    std::mutex registration_mutex_;
+    std::vector<TaskCreator> creators_; // indexed by TaskTypeId
+    PerfectHashMap<TaskCreator> lookup_; // built by freeze()
+    std::atomic<bool> frozen_{false};
+    
+    template<typename T>
+    static std::unique_ptr<TaskBase> create(const std::string& config) {
+        return std::make_unique<T>(T::from_config(config));
+    }
+    
+    TaskCreator find_creator(std::string_view type) {
+        if (!frozen()) {
+            freeze();
+        }
+        if (const TaskCreator* creator = lookup_.find(type)) {
+            return *creator;
+        }
+        throw std::runtime_error("Unknown task type: " + std::string(type));
+    }
 };
 
 // ============================================================================
@@ -0,0 +1,238 @@
+// Admission control for long-running submission: bounded concurrency, queue
+// length and memory, with blocking, rejection or priority-based shedding
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dtpf {
+
+// What a submission does when a limit is reached
+enum class OverloadPolicy {
+    Block,     // wait for room, up to max_block
+    Reject,    // refuse at once with a retry hint
+    ShedLowest // drop queued tasks of lower priority to make room, else refuse
+};
+
+struct AdmissionOptions {
+    size_t max_in_flight = std::max(1u, std::thread::hardware_concurrency()); // tasks running at once
+    size_t max_queued = 1024;                                                  // admitted tasks awaiting a worker
+    size_t memory_budget = 256 * 1024 * 1024; // estimated bytes of queued and running tasks
+    OverloadPolicy policy = OverloadPolicy::Block;
+    std::chrono::milliseconds max_block{0};   // Block gives up after this long; zero waits indefinitely
+    std::chrono::milliseconds initial_retry_after{100}; // retry hint until a run time has been measured
+};
+
+struct Admission {
+    enum class Status { Admitted, Rejected, Closed };
+
+    Status status = Status::Rejected;
+    std::uint64_t ticket = 0;               // identifies the task's result once admitted
+    std::chrono::milliseconds retry_after{0}; // when rejected, a guess at when room will free up
+
+    bool admitted() const { return status == Status::Admitted; }
+};
+
+struct AdmissionStats {
+    std::uint64_t admitted = 0;
+    std::uint64_t rejected = 0;
+    std::uint64_t shed = 0;      // admitted, then dropped for a higher-priority task
+    std::uint64_t completed = 0;
+    size_t queued = 0;
+    size_t in_flight = 0;
+    size_t bytes = 0;            // charged now
+    size_t peak_bytes = 0;
+};
+
+// ============================================================================
+// ADMISSION QUEUE: holds admitted work until a worker takes it, highest
+// priority first and in arrival order within a priority. Every item declares
+// its estimated memory, which is charged from admission until finish(), so
+// the budget covers running work as well as queued work. An item larger
+// than the whole budget is admitted only when nothing else is charged, so
+// it runs alone rather than never. Retry hints come from an average of
+// recent run times.
+// ============================================================================
+
+template<typename T>
+class AdmissionQueue {
+public:
+    struct Lease {
+        T item;
+        std::uint64_t ticket;
+        int priority;
+        size_t bytes;
+    };
+
+    using Stats = AdmissionStats;
+
+    explicit AdmissionQueue(const AdmissionOptions& options) : options_(options) {
+        options_.max_in_flight = std::max<size_t>(options_.max_in_flight, 1);
+        options_.max_queued = std::max<size_t>(options_.max_queued, 1);
+    }
+
+    // Items dropped to admit this one are appended to shed; their owners
+    // must be told
+    Admission push(T item, int priority, size_t bytes, std::vector<Lease>& shed) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (options_.policy == OverloadPolicy::Block) {
+            auto room = [&] { return closed_ || fits(bytes); };
+            if (options_.max_block.count() == 0) {
+                changed_.wait(lock, room);
+            } else if (!changed_.wait_for(lock, options_.max_block, room)) {
+                return reject();
+            }
+        } else if (options_.policy == OverloadPolicy::ShedLowest) {
+            make_room(priority, bytes, shed);
+        }
+        if (closed_) {
+            return Admission{Admission::Status::Closed};
+        }
+        if (!fits(bytes)) {
+            return reject();
+        }
+
+        std::uint64_t ticket = next_ticket_++;
+        queues_[priority].push_back(Lease{std::move(item), ticket, priority, bytes});
+        ++queued_;
+        charge(bytes);
+        ++stats_.admitted;
+        lock.unlock();
+        changed_.notify_all();
+        return Admission{Admission::Status::Admitted, ticket};
+    }
+
+    // Blocks until an item is queued and a run slot is free; nullopt once
+    // closed and drained. The caller owns the slot until finish().
+    std::optional<Lease> pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this] { return (queued_ > 0 && in_flight_ < options_.max_in_flight) ||
+                                            (closed_ && queued_ == 0); });
+        if (queued_ == 0) {
+            return std::nullopt;
+        }
+        auto highest = std::prev(queues_.end());
+        Lease lease = std::move(highest->second.front());
+        highest->second.pop_front();
+        if (highest->second.empty()) {
+            queues_.erase(highest);
+        }
+        --queued_;
+        ++in_flight_;
+        lock.unlock();
+        changed_.notify_all();
+        return lease;
+    }
+
+    // Releases a popped item's run slot and memory
+    void finish(const Lease& lease, std::chrono::steady_clock::duration run_time) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --in_flight_;
+            bytes_ -= lease.bytes;
+            ++stats_.completed;
+            double ms = std::chrono::duration<double, std::milli>(run_time).count();
+            mean_run_ms_ = stats_.completed == 1 ? ms : mean_run_ms_ + kRunTimeWeight * (ms - mean_run_ms_);
+        }
+        changed_.notify_all();
+    }
+
+    // Refuses new items; queued ones are still handed out
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        changed_.notify_all();
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats stats = stats_;
+        stats.queued = queued_;
+        stats.in_flight = in_flight_;
+        stats.bytes = bytes_;
+        return stats;
+    }
+
+private:
+    static constexpr double kRunTimeWeight = 0.2; // share of each new run time in the average
+
+    AdmissionOptions options_;
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::map<int, std::deque<Lease>> queues_; // by priority; the last is served first
+    size_t queued_ = 0;
+    size_t in_flight_ = 0;
+    size_t bytes_ = 0;
+    double mean_run_ms_ = 0;
+    std::uint64_t next_ticket_ = 1;
+    bool closed_ = false;
+    Stats stats_;
+
+    bool fits(size_t bytes) const {
+        return queued_ < options_.max_queued && (bytes_ == 0 || bytes_ + bytes <= options_.memory_budget);
+    }
+
+    void charge(size_t bytes) {
+        bytes_ += bytes;
+        stats_.peak_bytes = std::max(stats_.peak_bytes, bytes_);
+    }
+
+    // A slot frees when any running item finishes
+    Admission reject() {
+        ++stats_.rejected;
+        if (stats_.completed == 0) {
+            return Admission{Admission::Status::Rejected, 0, options_.initial_retry_after};
+        }
+        double wait_ms = mean_run_ms_ / static_cast<double>(std::max<size_t>(in_flight_, 1));
+        auto hint = std::chrono::milliseconds(static_cast<std::int64_t>(wait_ms) + 1);
+        return Admission{Admission::Status::Rejected, 0, hint};
+    }
+
+    // Sheds newest first from the lowest priorities, and only when enough
+    // lower-priority memory is queued to make the new item fit
+    void make_room(int priority, size_t bytes, std::vector<Lease>& shed) {
+        if (closed_ || fits(bytes)) {
+            return;
+        }
+        size_t sheddable_items = 0;
+        size_t sheddable_bytes = 0;
+        for (auto it = queues_.begin(); it != queues_.end() && it->first < priority; ++it) {
+            sheddable_items += it->second.size();
+            for (const auto& lease : it->second) {
+                sheddable_bytes += lease.bytes;
+            }
+        }
+        bool enough = sheddable_items > 0 && queued_ - sheddable_items < options_.max_queued &&
+                      (bytes_ - sheddable_bytes == 0 || bytes_ - sheddable_bytes + bytes <= options_.memory_budget);
+        if (!enough) {
+            return;
+        }
+        while (!fits(bytes)) {
+            auto lowest = queues_.begin();
+            Lease& victim = lowest->second.back();
+            bytes_ -= victim.bytes;
+            --queued_;
+            ++stats_.shed;
+            shed.push_back(std::move(victim));
+            lowest->second.pop_back();
+            if (lowest->second.empty()) {
+                queues_.erase(lowest);
+            }
+        }
+    }
+};
+
+}
@@ -0,0 +1,212 @@
+// Type-erased task result with small-buffer storage and lazy serialization
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+#include "dtpf/binary_codec.hpp"
+
+namespace dtpf {
+
+template<typename T>
+concept TextSerializable = std::same_as<T, std::string> || requires(const T& t) {
+    { t.serialize() } -> std::convertible_to<std::string>;
+};
+
+// ============================================================================
+// ANY RESULT: holds any movable, text-serializable result without formatting
+// it. Values up to kInlineSize bytes live inside the holder; larger ones are
+// heap-allocated. Text is only produced when to_string() is called.
+// ============================================================================
+
+class AnyResult {
+public:
+    static constexpr size_t kInlineSize = 64;
+
+    AnyResult() noexcept = default;
+
+    template<typename R>
+        requires (!std::same_as<std::decay_t<R>, AnyResult>) && TextSerializable<std::decay_t<R>>
+    AnyResult(R&& value) {
+        using T = std::decay_t<R>;
+        if constexpr (stored_inline<T>()) {
+            ::new (static_cast<void*>(storage_)) T(std::forward<R>(value));
+        } else {
+            ::new (static_cast<void*>(storage_)) T*(new T(std::forward<R>(value)));
+        }
+        ops_ = &ops_for<T>;
+    }
+
+    AnyResult(const AnyResult& other) {
+        if (other.ops_) {
+            other.ops_->copy(storage_, other.storage_);
+            ops_ = other.ops_;
+        }
+    }
+
+    AnyResult(AnyResult&& other) noexcept {
+        if (other.ops_) {
+            other.ops_->move(storage_, other.storage_);
+            ops_ = std::exchange(other.ops_, nullptr);
+        }
+    }
+
+    AnyResult& operator=(const AnyResult& other) {
+        if (this != &other) {
+            AnyResult copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    AnyResult& operator=(AnyResult&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.ops_) {
+                other.ops_->move(storage_, other.storage_);
+                ops_ = std::exchange(other.ops_, nullptr);
+            }
+        }
+        return *this;
+    }
+
+    ~AnyResult() {
+        reset();
+    }
+
+    void reset() noexcept {
+        if (ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    bool has_value() const noexcept {
+        return ops_ != nullptr;
+    }
+
+    const std::type_info& type() const noexcept {
+        return ops_ ? ops_->type() : typeid(void);
+    }
+
+    template<typename T>
+    bool holds() const noexcept {
+        return ops_ == &ops_for<T>;
+    }
+
+    template<typename T>
+    T* get_if() noexcept {
+        return holds<T>() ? static_cast<T*>(ops_->address(storage_)) : nullptr;
+    }
+
+    template<typename T>
+    const T* get_if() const noexcept {
+        return holds<T>() ? static_cast<const T*>(ops_->address(const_cast<unsigned char*>(storage_))) : nullptr;
+    }
+
+    // The serialization boundary: formats the held value as text
+    std::string to_string() const {
+        return ops_ ? ops_->serialize(storage_) : std::string{};
+    }
+
+    // Binary boundary; returns false when the held type has no binary form
+    bool to_binary(BinaryWriter& writer) const {
+        return ops_ && ops_->serialize_binary(storage_, writer);
+    }
+
+private:
+    struct Ops {
+        void (*destroy)(unsigned char*) noexcept;
+        void (*copy)(unsigned char* dst, const unsigned char* src);
+        void (*move)(unsigned char* dst, unsigned char* src) noexcept;
+        void* (*address)(unsigned char*) noexcept;
+        std::string (*serialize)(const unsigned char*);
+        bool (*serialize_binary)(const unsigned char*, BinaryWriter&);
+        const std::type_info& (*type)() noexcept;
+    };
+
+    template<typename T>
+    static constexpr bool stored_inline() {
+        return sizeof(T) <= kInlineSize && alignof(T) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible_v<T>;
+    }
+
+    template<typename T>
+    static const T& ref(const unsigned char* storage) {
+        if constexpr (stored_inline<T>()) {
+            return *std::launder(reinterpret_cast<const T*>(storage));
+        } else {
+            return **std::launder(reinterpret_cast<T* const*>(storage));
+        }
+    }
+
+    template<typename T>
+    static std::string serialize_value(const T& value) {
+        if constexpr (std::same_as<T, std::string>) {
+            return value;
+        } else {
+            return value.serialize();
+        }
+    }
+
+    template<typename T>
+    static constexpr Ops ops_for = {
+        [](unsigned char* s) noexcept {
+            if constexpr (stored_inline<T>()) {
+                std::launder(reinterpret_cast<T*>(s))->~T();
+            } else {
+                delete *std::launder(reinterpret_cast<T**>(s));
+            }
+        },
+        [](unsigned char* dst, const unsigned char* src) {
+            if constexpr (stored_inline<T>()) {
+                ::new (static_cast<void*>(dst)) T(ref<T>(src));
+            } else {
+                ::new (static_cast<void*>(dst)) T*(new T(ref<T>(src)));
+            }
+        },
+        [](unsigned char* dst, unsigned char* src) noexcept {
+            if constexpr (stored_inline<T>()) {
+                T* from = std::launder(reinterpret_cast<T*>(src));
+                ::new (static_cast<void*>(dst)) T(std::move(*from));
+                from->~T();
+            } else {
+                // Heap values move by handing over the pointer
+                ::new (static_cast<void*>(dst)) T*(*std::launder(reinterpret_cast<T**>(src)));
+            }
+        },
+        [](unsigned char* s) noexcept -> void* {
+            if constexpr (stored_inline<T>()) {
+                return std::launder(reinterpret_cast<T*>(s));
+            } else {
+                return *std::launder(reinterpret_cast<T**>(s));
+            }
+        },
+        [](const unsigned char* s) { return serialize_value(ref<T>(s)); },
+        [](const unsigned char* s, BinaryWriter& writer) {
+            if constexpr (requires(const T& t) { t.serialize_binary(writer); }) {
+                ref<T>(s).serialize_binary(writer);
+                return true;
+            } else {
+                return false;
+            }
+        },
+        []() noexcept -> const std::type_info& { return typeid(T); }
+    };
+
+    alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+    const Ops* ops_ = nullptr;
+};
+
+// Receives typed results with the index of the task that produced them
+using TypedResultCallback = std::function<void(size_t index, AnyResult result)>;
+
+}
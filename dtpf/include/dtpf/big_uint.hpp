@@ -0,0 +1,357 @@
+// Arbitrary-precision unsigned integers with Karatsuba multiplication
+
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dtpf {
+
+namespace detail {
+
+// Limbs hold base 10^9 digits, least significant first. Printing is then a
+// linear pass, which matters when results run to millions of digits.
+using BigLimb = std::uint32_t;
+using BigLimbs = std::vector<BigLimb>;
+inline constexpr std::uint64_t kBigBase = 1'000'000'000;
+
+inline constexpr size_t kKaratsubaLimbs = 48;   // below this schoolbook is faster
+inline constexpr size_t kParallelLimbs = 4096;  // below this a thread costs more than it saves
+
+inline void trim(BigLimbs& limbs) {
+    while (!limbs.empty() && limbs.back() == 0) {
+        limbs.pop_back();
+    }
+}
+
+inline std::span<const BigLimb> trimmed(std::span<const BigLimb> limbs) {
+    while (!limbs.empty() && limbs.back() == 0) {
+        limbs = limbs.first(limbs.size() - 1);
+    }
+    return limbs;
+}
+
+// out[offset..] += a; out must be long enough to take the final carry
+inline void add_into(BigLimbs& out, std::span<const BigLimb> a, size_t offset = 0) {
+    std::uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < a.size(); ++i) {
+        std::uint64_t sum = std::uint64_t{out[offset + i]} + a[i] + carry;
+        carry = sum >= kBigBase;
+        out[offset + i] = static_cast<BigLimb>(carry ? sum - kBigBase : sum);
+    }
+    for (; carry; ++i) {
+        std::uint64_t sum = std::uint64_t{out[offset + i]} + carry;
+        carry = sum >= kBigBase;
+        out[offset + i] = static_cast<BigLimb>(carry ? sum - kBigBase : sum);
+    }
+}
+
+// out -= a, where out >= a
+inline void sub_into(BigLimbs& out, std::span<const BigLimb> a) {
+    std::int64_t borrow = 0;
+    size_t i = 0;
+    for (; i < a.size(); ++i) {
+        std::int64_t diff = std::int64_t{out[i]} - a[i] - borrow;
+        borrow = diff < 0;
+        out[i] = static_cast<BigLimb>(borrow ? diff + static_cast<std::int64_t>(kBigBase) : diff);
+    }
+    for (; borrow; ++i) {
+        std::int64_t diff = std::int64_t{out[i]} - borrow;
+        borrow = diff < 0;
+        out[i] = static_cast<BigLimb>(borrow ? diff + static_cast<std::int64_t>(kBigBase) : diff);
+    }
+}
+
+inline BigLimbs add(std::span<const BigLimb> a, std::span<const BigLimb> b) {
+    if (a.size() < b.size()) {
+        std::swap(a, b);
+    }
+    BigLimbs sum(a.begin(), a.end());
+    sum.push_back(0);
+    add_into(sum, b);
+    trim(sum);
+    return sum;
+}
+
+// Column sums are kept in 64 bits and only reduced every kRowsPerCarry rows,
+// so the inner loop is a plain multiply-add
+inline BigLimbs schoolbook_multiply(std::span<const BigLimb> a, std::span<const BigLimb> b) {
+    constexpr size_t kRowsPerCarry = 16; // 16 * (10^9 - 1)^2 + 10^9 stays below 2^64
+    std::vector<std::uint64_t> columns(a.size() + b.size(), 0);
+    auto carry_all = [&] {
+        std::uint64_t carry = 0;
+        for (auto& column : columns) {
+            column += carry;
+            carry = column / kBigBase;
+            column %= kBigBase;
+        }
+    };
+    for (size_t i = 0; i < a.size(); ++i) {
+        std::uint64_t digit = a[i];
+        std::uint64_t* out = columns.data() + i;
+        for (size_t j = 0; j < b.size(); ++j) {
+            out[j] += digit * b[j];
+        }
+        if ((i + 1) % kRowsPerCarry == 0) {
+            carry_all();
+        }
+    }
+    carry_all();
+    return BigLimbs(columns.begin(), columns.end());
+}
+
+// a * b; the product may have leading zero limbs
+inline BigLimbs multiply(std::span<const BigLimb> a, std::span<const BigLimb> b, unsigned parallel_depth) {
+    a = trimmed(a);
+    b = trimmed(b);
+    if (a.size() < b.size()) {
+        std::swap(a, b);
+    }
+    if (b.empty()) {
+        return {};
+    }
+    if (b.size() < kKaratsubaLimbs) {
+        return schoolbook_multiply(a, b);
+    }
+
+    BigLimbs product(a.size() + b.size() + 1, 0);
+
+    // Lopsided operands: multiply b by each b-sized slice of a
+    if (a.size() >= 2 * b.size()) {
+        for (size_t offset = 0; offset < a.size(); offset += b.size()) {
+            auto slice = a.subspan(offset, std::min(b.size(), a.size() - offset));
+            add_into(product, multiply(slice, b, parallel_depth), offset);
+        }
+        return product;
+    }
+
+    // Karatsuba: a = a1*B^m + a0, b = b1*B^m + b0 and
+    // a*b = z2*B^2m + (z1 - z2 - z0)*B^m + z0 with z1 = (a0 + a1)(b0 + b1)
+    size_t m = a.size() / 2;
+    auto a0 = a.first(m), a1 = a.subspan(m);
+    auto b0 = b.first(m), b1 = b.subspan(m);
+    BigLimbs a_sum = add(a0, a1);
+    BigLimbs b_sum = add(b0, b1);
+
+    BigLimbs z0, z1, z2;
+    if (parallel_depth > 0 && b.size() >= kParallelLimbs) {
+        auto high = std::async(std::launch::async, [&] { return multiply(a1, b1, parallel_depth - 1); });
+        auto middle = std::async(std::launch::async, [&] { return multiply(a_sum, b_sum, parallel_depth - 1); });
+        z0 = multiply(a0, b0, parallel_depth - 1);
+        z2 = high.get();
+        z1 = middle.get();
+    } else {
+        z0 = multiply(a0, b0, 0);
+        z2 = multiply(a1, b1, 0);
+        z1 = multiply(a_sum, b_sum, 0);
+    }
+    sub_into(z1, trimmed(z0));
+    sub_into(z1, trimmed(z2));
+
+    add_into(product, trimmed(z0));
+    add_into(product, trimmed(z1), m);
+    add_into(product, trimmed(z2), 2 * m);
+    return product;
+}
+
+}
+
+// ============================================================================
+// BIG UNSIGNED INTEGER: exact non-negative integers of any size. Products of
+// large operands use Karatsuba, and may split their three half-size products
+// across threads when a parallel depth is given.
+// ============================================================================
+
+class BigUint {
+public:
+    BigUint() = default;
+
+    BigUint(std::uint64_t value) {
+        while (value > 0) {
+            limbs_.push_back(static_cast<detail::BigLimb>(value % detail::kBigBase));
+            value /= detail::kBigBase;
+        }
+    }
+
+    bool is_zero() const { return limbs_.empty(); }
+
+    // The value, if it fits in 64 bits
+    std::optional<std::uint64_t> to_u64() const {
+        std::uint64_t value = 0;
+        for (auto it = limbs_.rbegin(); it != limbs_.rend(); ++it) {
+            if (value > (std::numeric_limits<std::uint64_t>::max() - *it) / detail::kBigBase) {
+                return std::nullopt;
+            }
+            value = value * detail::kBigBase + *it;
+        }
+        return value;
+    }
+
+    size_t digit_count() const {
+        if (limbs_.empty()) {
+            return 1;
+        }
+        return (limbs_.size() - 1) * 9 + std::to_string(limbs_.back()).size();
+    }
+
+    std::string to_string() const {
+        if (limbs_.empty()) {
+            return "0";
+        }
+        std::string text = std::to_string(limbs_.back());
+        text.reserve(digit_count());
+        for (size_t i = limbs_.size() - 1; i-- > 0;) {
+            std::string digits = std::to_string(limbs_[i]);
+            text.append(9 - digits.size(), '0');
+            text += digits;
+        }
+        return text;
+    }
+
+    static BigUint multiply(const BigUint& a, const BigUint& b, unsigned parallel_depth = 0) {
+        BigUint product;
+        product.limbs_ = detail::multiply(a.limbs_, b.limbs_, parallel_depth);
+        detail::trim(product.limbs_);
+        return product;
+    }
+
+    // Multiplies in place by a factor below 10^9
+    BigUint& multiply_small(std::uint32_t factor) {
+        if (factor >= detail::kBigBase) {
+            throw std::invalid_argument("BigUint::multiply_small factor must be below 10^9");
+        }
+        std::uint64_t carry = 0;
+        for (auto& limb : limbs_) {
+            std::uint64_t current = std::uint64_t{limb} * factor + carry;
+            limb = static_cast<detail::BigLimb>(current % detail::kBigBase);
+            carry = current / detail::kBigBase;
+        }
+        if (carry) {
+            limbs_.push_back(static_cast<detail::BigLimb>(carry));
+        }
+        detail::trim(limbs_);
+        return *this;
+    }
+
+    BigUint& operator+=(const BigUint& other) {
+        limbs_.resize(std::max(limbs_.size(), other.limbs_.size()) + 1, 0);
+        detail::add_into(limbs_, other.limbs_);
+        detail::trim(limbs_);
+        return *this;
+    }
+
+    BigUint& operator-=(const BigUint& other) {
+        if (*this < other) {
+            throw std::domain_error("BigUint subtraction would go below zero");
+        }
+        detail::sub_into(limbs_, other.limbs_);
+        detail::trim(limbs_);
+        return *this;
+    }
+
+    friend BigUint operator+(BigUint a, const BigUint& b) { return a += b; }
+    friend BigUint operator-(BigUint a, const BigUint& b) { return a -= b; }
+    friend BigUint operator*(const BigUint& a, const BigUint& b) { return multiply(a, b); }
+
+    friend bool operator==(const BigUint&, const BigUint&) = default;
+
+    friend std::strong_ordering operator<=>(const BigUint& a, const BigUint& b) {
+        if (a.limbs_.size() != b.limbs_.size()) {
+            return a.limbs_.size() <=> b.limbs_.size();
+        }
+        return std::lexicographical_compare_three_way(a.limbs_.rbegin(), a.limbs_.rend(),
+                                                      b.limbs_.rbegin(), b.limbs_.rend());
+    }
+
+private:
+    detail::BigLimbs limbs_; // no leading zero limbs; zero is empty
+};
+
+// ============================================================================
+// FAST ALGORITHMS
+// ============================================================================
+
+// F(n) by fast doubling: F(2k) = F(k) * (2F(k+1) - F(k)) and
+// F(2k+1) = F(k)^2 + F(k+1)^2, one step per bit of n
+inline BigUint fibonacci(std::uint64_t n, unsigned parallel_depth = 0) {
+    BigUint a = 0; // F(k)
+    BigUint b = 1; // F(k+1)
+    for (int bit = std::numeric_limits<std::uint64_t>::digits - 1; bit >= 0; --bit) {
+        if ((n >> bit) == 0) {
+            continue;
+        }
+        bool odd = (n >> bit) & 1;
+        if (bit == 0) {
+            // Only F(n) is needed from the last step
+            if (odd) {
+                return BigUint::multiply(a, a, parallel_depth) + BigUint::multiply(b, b, parallel_depth);
+            }
+            return BigUint::multiply(a, b + b - a, parallel_depth);
+        }
+        BigUint even = BigUint::multiply(a, b + b - a, parallel_depth);
+        BigUint next = BigUint::multiply(a, a, parallel_depth) + BigUint::multiply(b, b, parallel_depth);
+        if (odd) {
+            a = std::move(next);
+            b = even + a;
+        } else {
+            a = std::move(even);
+            b = std::move(next);
+        }
+    }
+    return a;
+}
+
+namespace detail {
+
+// Product of lo..hi inclusive, split in halves so that multiplications pair
+// operands of similar size
+inline BigUint product_range(std::uint64_t lo, std::uint64_t hi, unsigned parallel_depth) {
+    if (hi - lo < 32) {
+        BigUint product = 1;
+        std::uint64_t packed = 1; // several small factors per limb multiply
+        for (std::uint64_t k = lo;; ++k) {
+            if (k >= kBigBase) {
+                product = BigUint::multiply(product, BigUint(k));
+            } else if (packed * k >= kBigBase) {
+                product.multiply_small(static_cast<std::uint32_t>(packed));
+                packed = k;
+            } else {
+                packed *= k;
+            }
+            if (k == hi) {
+                break;
+            }
+        }
+        return product.multiply_small(static_cast<std::uint32_t>(packed));
+    }
+    std::uint64_t mid = lo + (hi - lo) / 2;
+    if (parallel_depth > 0 && hi - lo >= kParallelLimbs) {
+        auto low = std::async(std::launch::async, [&] { return product_range(lo, mid, parallel_depth - 1); });
+        BigUint high = product_range(mid + 1, hi, parallel_depth - 1);
+        return BigUint::multiply(low.get(), high, parallel_depth);
+    }
+    return BigUint::multiply(product_range(lo, mid, 0), product_range(mid + 1, hi, 0), parallel_depth);
+}
+
+}
+
+// n! by binary splitting of the product 2 * 3 * ... * n
+inline BigUint factorial(std::uint64_t n, unsigned parallel_depth = 0) {
+    if (n < 2) {
+        return 1;
+    }
+    return detail::product_range(2, n, parallel_depth);
+}
+
+}
@@ -0,0 +1,166 @@
+// Compact binary encoding: LEB128 varints, zigzag integers and length-prefixed bytes
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace dtpf {
+
+// ============================================================================
+// BINARY WRITER
+// ============================================================================
+
+class BinaryWriter {
+public:
+    constexpr BinaryWriter() = default;
+
+    // Reuses the capacity of an existing buffer
+    constexpr explicit BinaryWriter(std::string buffer) : buffer_(std::move(buffer)) {
+        buffer_.clear();
+    }
+
+    constexpr void write_u8(std::uint8_t value) {
+        buffer_.push_back(static_cast<char>(value));
+    }
+
+    constexpr void write_varint(std::uint64_t value) {
+        while (value >= 0x80) {
+            buffer_.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        buffer_.push_back(static_cast<char>(value));
+    }
+
+    // Zigzag keeps small negative numbers small on the wire
+    constexpr void write_signed(std::int64_t value) {
+        write_varint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+    }
+
+    constexpr void write_fixed64(std::uint64_t value) {
+        for (int shift = 0; shift < 64; shift += 8) {
+            buffer_.push_back(static_cast<char>((value >> shift) & 0xFF));
+        }
+    }
+
+    constexpr void write_bytes(std::string_view bytes) {
+        write_varint(bytes.size());
+        buffer_.append(bytes);
+    }
+
+    constexpr std::string_view view() const { return buffer_; }
+    constexpr std::string take() { return std::move(buffer_); }
+    constexpr void clear() { buffer_.clear(); }
+
+private:
+    std::string buffer_;
+};
+
+// ============================================================================
+// BINARY READER: bounds-checked, never copies; string fields are views into
+// the input. Any malformed read sets a sticky failure flag.
+// ============================================================================
+
+class BinaryReader {
+public:
+    constexpr explicit BinaryReader(std::string_view input) : input_(input) {}
+
+    constexpr std::uint8_t read_u8() {
+        if (!ok_ || position_ >= input_.size()) {
+            return fail(), 0;
+        }
+        return static_cast<std::uint8_t>(input_[position_++]);
+    }
+
+    constexpr std::uint64_t read_varint() {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (!ok_ || position_ >= input_.size()) {
+                return fail(), 0;
+            }
+            auto byte = static_cast<std::uint8_t>(input_[position_++]);
+            if (shift == 63 && byte > 1) {
+                return fail(), 0; // overflows 64 bits
+            }
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        return fail(), 0;
+    }
+
+    constexpr std::int64_t read_signed() {
+        std::uint64_t raw = read_varint();
+        return static_cast<std::int64_t>((raw >> 1) ^ (~(raw & 1) + 1));
+    }
+
+    constexpr std::uint64_t read_fixed64() {
+        if (!ok_ || input_.size() - position_ < 8) {
+            return fail(), 0;
+        }
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 8) {
+            value |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(input_[position_++])) << shift;
+        }
+        return value;
+    }
+
+    constexpr std::string_view read_bytes() {
+        std::uint64_t size = read_varint();
+        if (!ok_ || size > input_.size() - position_) {
+            return fail(), std::string_view{};
+        }
+        std::string_view bytes = input_.substr(position_, static_cast<size_t>(size));
+        position_ += static_cast<size_t>(size);
+        return bytes;
+    }
+
+    constexpr bool ok() const { return ok_; }
+    constexpr bool at_end() const { return position_ == input_.size(); }
+    constexpr size_t position() const { return position_; }
+
+private:
+    constexpr void fail() { ok_ = false; }
+
+    std::string_view input_;
+    size_t position_ = 0;
+    bool ok_ = true;
+};
+
+namespace detail {
+
+// Compile-time round trip of the encoding edge cases
+constexpr bool binary_codec_round_trips() {
+    BinaryWriter writer;
+    writer.write_varint(0);
+    writer.write_varint(127);
+    writer.write_varint(128);
+    writer.write_varint(~std::uint64_t{0});
+    writer.write_signed(-1);
+    writer.write_signed(INT64_MIN);
+    writer.write_signed(INT64_MAX);
+    writer.write_fixed64(0x0123456789ABCDEFull);
+    writer.write_bytes("a:b:c");
+
+    BinaryReader reader(writer.view());
+    return reader.read_varint() == 0
+        && reader.read_varint() == 127
+        && reader.read_varint() == 128
+        && reader.read_varint() == ~std::uint64_t{0}
+        && reader.read_signed() == -1
+        && reader.read_signed() == INT64_MIN
+        && reader.read_signed() == INT64_MAX
+        && reader.read_fixed64() == 0x0123456789ABCDEFull
+        && reader.read_bytes() == "a:b:c"
+        && reader.ok() && reader.at_end();
+}
+
+static_assert(binary_codec_round_trips(), "binary codec must round-trip");
+
+}
+
+}
@@ -0,0 +1,576 @@
+// Byte-level transform kernels with scalar, SSE4.2 and AVX2 versions
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define DTPF_HAS_X86_KERNELS 1
+#endif
+
+namespace dtpf {
+
+enum class CharClass : std::uint8_t {
+    Digit, // 0-9
+    Alpha, // A-Z, a-z
+    Space  // space, \t \n \v \f \r
+};
+
+// One implementation of every kernel for a given instruction set. Outputs
+// may alias inputs for the same-size kernels.
+struct ByteKernels {
+    const char* isa;
+    void (*to_upper)(const char* in, size_t size, char* out);
+    void (*to_lower)(const char* in, size_t size, char* out);
+    size_t (*filter_printable)(const char* in, size_t size, char* out); // returns bytes written
+    std::uint64_t (*count_class)(const char* in, size_t size, CharClass cls);
+    std::uint64_t (*count_byte)(const char* in, size_t size, char byte);
+    std::uint32_t (*crc32c)(std::uint32_t crc, const char* in, size_t size);
+};
+
+// ============================================================================
+// SCALAR KERNELS: the reference versions, also used for SIMD tails
+// ============================================================================
+
+namespace detail::scalar {
+
+inline bool in_range(unsigned char c, unsigned char lo, unsigned char hi) {
+    return static_cast<unsigned char>(c - lo) <= static_cast<unsigned char>(hi - lo);
+}
+
+// Ranges are inclusive; a class is the union of two
+inline std::array<unsigned char, 4> class_ranges(CharClass cls) {
+    switch (cls) {
+        case CharClass::Digit: return {'0', '9', '0', '9'};
+        case CharClass::Alpha: return {'A', 'Z', 'a', 'z'};
+        case CharClass::Space: return {'\t', '\r', ' ', ' '};
+    }
+    return {1, 0, 1, 0};
+}
+
+inline bool is_kept(unsigned char c) {
+    return in_range(c, 0x20, 0x7e) || c == '\n' || c == '\t';
+}
+
+inline void flip_case(const char* in, size_t size, char* out, unsigned char lo, unsigned char hi) {
+    for (size_t i = 0; i < size; ++i) {
+        auto c = static_cast<unsigned char>(in[i]);
+        out[i] = static_cast<char>(in_range(c, lo, hi) ? c ^ 0x20 : c);
+    }
+}
+
+inline void to_upper(const char* in, size_t size, char* out) { flip_case(in, size, out, 'a', 'z'); }
+inline void to_lower(const char* in, size_t size, char* out) { flip_case(in, size, out, 'A', 'Z'); }
+
+inline size_t filter_printable(const char* in, size_t size, char* out) {
+    size_t written = 0;
+    for (size_t i = 0; i < size; ++i) {
+        out[written] = in[i];
+        written += is_kept(static_cast<unsigned char>(in[i]));
+    }
+    return written;
+}
+
+inline std::uint64_t count_class(const char* in, size_t size, CharClass cls) {
+    auto r = class_ranges(cls);
+    std::uint64_t count = 0;
+    for (size_t i = 0; i < size; ++i) {
+        auto c = static_cast<unsigned char>(in[i]);
+        count += in_range(c, r[0], r[1]) || in_range(c, r[2], r[3]);
+    }
+    return count;
+}
+
+inline std::uint64_t count_byte(const char* in, size_t size, char byte) {
+    std::uint64_t count = 0;
+    for (size_t i = 0; i < size; ++i) {
+        count += in[i] == byte;
+    }
+    return count;
+}
+
+// CRC-32C (Castagnoli), reflected polynomial 0x82f63b78
+inline constexpr std::uint32_t kCrc32cPolynomial = 0x82f63b78;
+
+inline constexpr auto kCrc32cTable = [] {
+    std::array<std::uint32_t, 256> table{};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = crc & 1 ? (crc >> 1) ^ kCrc32cPolynomial : crc >> 1;
+        }
+        table[i] = crc;
+    }
+    return table;
+}();
+
+inline std::uint32_t crc32c(std::uint32_t crc, const char* in, size_t size) {
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = kCrc32cTable[(crc ^ static_cast<unsigned char>(in[i])) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+}
+
+// ============================================================================
+// SIMD KERNELS: the same kernels 16 (SSE4.2) or 32 (AVX2) bytes at a time.
+// Byte ranges are tested with signed compares, which is exact because every
+// range lies within 0x01-0x7e. Counts accumulate per byte lane and are
+// widened every 255 blocks.
+// ============================================================================
+
+#ifdef DTPF_HAS_X86_KERNELS
+
+namespace detail::sse42 {
+
+#define DTPF_SSE42 __attribute__((target("sse4.2,popcnt")))
+
+DTPF_SSE42 inline __m128i in_range(__m128i v, unsigned char lo, unsigned char hi) {
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                         _mm_cmpgt_epi8(_mm_set1_epi8(static_cast<char>(hi + 1)), v));
+}
+
+DTPF_SSE42 inline void flip_case(const char* in, size_t size, char* out, unsigned char lo, unsigned char hi) {
+    const __m128i flip = _mm_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        v = _mm_xor_si128(v, _mm_and_si128(in_range(v, lo, hi), flip));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+    }
+    scalar::flip_case(in + i, size - i, out + i, lo, hi);
+}
+
+DTPF_SSE42 inline void to_upper(const char* in, size_t size, char* out) { flip_case(in, size, out, 'a', 'z'); }
+DTPF_SSE42 inline void to_lower(const char* in, size_t size, char* out) { flip_case(in, size, out, 'A', 'Z'); }
+
+// Shuffle indices that move the bytes selected by an 8-bit mask to the front
+inline constexpr auto kCompressShuffles = [] {
+    std::array<std::uint64_t, 256> shuffles{};
+    for (unsigned mask = 0; mask < 256; ++mask) {
+        unsigned slot = 0;
+        for (unsigned bit = 0; bit < 8; ++bit) {
+            if (mask & (1u << bit)) {
+                shuffles[mask] |= std::uint64_t{bit} << (8 * slot++);
+            }
+        }
+    }
+    return shuffles;
+}();
+
+DTPF_SSE42 inline __m128i keep_mask(__m128i v) {
+    return _mm_or_si128(in_range(v, 0x20, 0x7e), _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')),
+                                                              _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))));
+}
+
+// Writes the bytes of v selected by mask to out, in order, and returns how
+// many there were. Up to 16 bytes at out may be written.
+DTPF_SSE42 inline size_t compress(__m128i v, unsigned mask, char* out) {
+    unsigned low = mask & 0xff;
+    unsigned high = mask >> 8;
+    __m128i shuffle = _mm_set_epi64x(static_cast<long long>(kCompressShuffles[high] + 0x0808080808080808ull),
+                                     static_cast<long long>(kCompressShuffles[low]));
+    __m128i packed = _mm_shuffle_epi8(v, shuffle);
+    size_t low_count = static_cast<size_t>(__builtin_popcount(low));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), packed);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out + low_count), _mm_unpackhi_epi64(packed, packed));
+    return low_count + static_cast<size_t>(__builtin_popcount(high));
+}
+
+DTPF_SSE42 inline size_t filter_printable(const char* in, size_t size, char* out) {
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        written += compress(v, static_cast<unsigned>(_mm_movemask_epi8(keep_mask(v))), out + written);
+    }
+    return written + scalar::filter_printable(in + i, size - i, out + written);
+}
+
+// Sums the per-lane counts in bytes into 64-bit lanes
+DTPF_SSE42 inline __m128i widen(__m128i totals, __m128i bytes) {
+    return _mm_add_epi64(totals, _mm_sad_epu8(bytes, _mm_setzero_si128()));
+}
+
+DTPF_SSE42 inline std::uint64_t horizontal_sum(__m128i totals) {
+    return static_cast<std::uint64_t>(_mm_cvtsi128_si64(totals)) +
+           static_cast<std::uint64_t>(_mm_extract_epi64(totals, 1));
+}
+
+DTPF_SSE42 inline std::uint64_t count_class(const char* in, size_t size, CharClass cls) {
+    auto r = scalar::class_ranges(cls);
+    __m128i totals = _mm_setzero_si128();
+    __m128i lanes = _mm_setzero_si128();
+    size_t i = 0;
+    for (unsigned blocks = 0; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        lanes = _mm_sub_epi8(lanes, _mm_or_si128(in_range(v, r[0], r[1]), in_range(v, r[2], r[3])));
+        if (++blocks == 255) {
+            totals = widen(totals, lanes);
+            lanes = _mm_setzero_si128();
+            blocks = 0;
+        }
+    }
+    return horizontal_sum(widen(totals, lanes)) + scalar::count_class(in + i, size - i, cls);
+}
+
+DTPF_SSE42 inline std::uint64_t count_byte(const char* in, size_t size, char byte) {
+    const __m128i target = _mm_set1_epi8(byte);
+    __m128i totals = _mm_setzero_si128();
+    __m128i lanes = _mm_setzero_si128();
+    size_t i = 0;
+    for (unsigned blocks = 0; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        lanes = _mm_sub_epi8(lanes, _mm_cmpeq_epi8(v, target));
+        if (++blocks == 255) {
+            totals = widen(totals, lanes);
+            lanes = _mm_setzero_si128();
+            blocks = 0;
+        }
+    }
+    return horizontal_sum(widen(totals, lanes)) + scalar::count_byte(in + i, size - i, byte);
+}
+
+// The SSE4.2 crc32 instruction computes CRC-32C directly
+DTPF_SSE42 inline std::uint32_t crc32c(std::uint32_t crc, const char* in, size_t size) {
+    std::uint64_t state = ~crc;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, in + i, 8);
+        state = _mm_crc32_u64(state, word);
+    }
+    auto narrow = static_cast<std::uint32_t>(state);
+    for (; i < size; ++i) {
+        narrow = _mm_crc32_u8(narrow, static_cast<unsigned char>(in[i]));
+    }
+    return ~narrow;
+}
+
+#undef DTPF_SSE42
+
+}
+
+namespace detail::avx2 {
+
+#define DTPF_AVX2 __attribute__((target("avx2,sse4.2,popcnt")))
+
+DTPF_AVX2 inline __m256i in_range(__m256i v, unsigned char lo, unsigned char hi) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(static_cast<char>(lo - 1))),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), v));
+}
+
+DTPF_AVX2 inline void flip_case(const char* in, size_t size, char* out, unsigned char lo, unsigned char hi) {
+    const __m256i flip = _mm256_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        v = _mm256_xor_si256(v, _mm256_and_si256(in_range(v, lo, hi), flip));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+    }
+    sse42::flip_case(in + i, size - i, out + i, lo, hi);
+}
+
+DTPF_AVX2 inline void to_upper(const char* in, size_t size, char* out) { flip_case(in, size, out, 'a', 'z'); }
+DTPF_AVX2 inline void to_lower(const char* in, size_t size, char* out) { flip_case(in, size, out, 'A', 'Z'); }
+
+DTPF_AVX2 inline size_t filter_printable(const char* in, size_t size, char* out) {
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i keep = _mm256_or_si256(in_range(v, 0x20, 0x7e),
+                                       _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')),
+                                                       _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))));
+        auto mask = static_cast<unsigned>(_mm256_movemask_epi8(keep));
+        if (mask == 0xffffffffu) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + written), v);
+            written += 32;
+        } else {
+            written += sse42::compress(_mm256_castsi256_si128(v), mask & 0xffff, out + written);
+            written += sse42::compress(_mm256_extracti128_si256(v, 1), mask >> 16, out + written);
+        }
+    }
+    return written + sse42::filter_printable(in + i, size - i, out + written);
+}
+
+DTPF_AVX2 inline __m256i widen(__m256i totals, __m256i bytes) {
+    return _mm256_add_epi64(totals, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+}
+
+DTPF_AVX2 inline std::uint64_t horizontal_sum(__m256i totals) {
+    __m128i pairs = _mm_add_epi64(_mm256_castsi256_si128(totals), _mm256_extracti128_si256(totals, 1));
+    return static_cast<std::uint64_t>(_mm_cvtsi128_si64(pairs)) +
+           static_cast<std::uint64_t>(_mm_extract_epi64(pairs, 1));
+}
+
+DTPF_AVX2 inline std::uint64_t count_class(const char* in, size_t size, CharClass cls) {
+    auto r = scalar::class_ranges(cls);
+    __m256i totals = _mm256_setzero_si256();
+    __m256i lanes = _mm256_setzero_si256();
+    size_t i = 0;
+    for (unsigned blocks = 0; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        lanes = _mm256_sub_epi8(lanes, _mm256_or_si256(in_range(v, r[0], r[1]), in_range(v, r[2], r[3])));
+        if (++blocks == 255) {
+            totals = widen(totals, lanes);
+            lanes = _mm256_setzero_si256();
+            blocks = 0;
+        }
+    }
+    return horizontal_sum(widen(totals, lanes)) + sse42::count_class(in + i, size - i, cls);
+}
+
+DTPF_AVX2 inline std::uint64_t count_byte(const char* in, size_t size, char byte) {
+    const __m256i target = _mm256_set1_epi8(byte);
+    __m256i totals = _mm256_setzero_si256();
+    __m256i lanes = _mm256_setzero_si256();
+    size_t i = 0;
+    for (unsigned blocks = 0; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        lanes = _mm256_sub_epi8(lanes, _mm256_cmpeq_epi8(v, target));
+        if (++blocks == 255) {
+            totals = widen(totals, lanes);
+            lanes = _mm256_setzero_si256();
+            blocks = 0;
+        }
+    }
+    return horizontal_sum(widen(totals, lanes)) + sse42::count_byte(in + i, size - i, byte);
+}
+
+#undef DTPF_AVX2
+
+}
+
+#endif
+
+// ============================================================================
+// DISPATCH: the best supported kernel set is picked once, on first use
+// ============================================================================
+
+inline const ByteKernels& scalar_byte_kernels() {
+    static constexpr ByteKernels kernels{
+        "scalar",
+        detail::scalar::to_upper,
+        detail::scalar::to_lower,
+        detail::scalar::filter_printable,
+        detail::scalar::count_class,
+        detail::scalar::count_byte,
+        detail::scalar::crc32c,
+    };
+    return kernels;
+}
+
+// nullptr when the ISA ("scalar", "sse4.2" or "avx2") is unknown or unsupported here
+inline const ByteKernels* byte_kernels_for(std::string_view isa) {
+    if (isa == "scalar") {
+        return &scalar_byte_kernels();
+    }
+#ifdef DTPF_HAS_X86_KERNELS
+    if (isa == "sse4.2" && __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt")) {
+        static constexpr ByteKernels kernels{
+            "sse4.2",
+            detail::sse42::to_upper,
+            detail::sse42::to_lower,
+            detail::sse42::filter_printable,
+            detail::sse42::count_class,
+            detail::sse42::count_byte,
+            detail::sse42::crc32c,
+        };
+        return &kernels;
+    }
+    // AVX2 has no wider CRC instruction, so the checksum stays on SSE4.2
+    if (isa == "avx2" && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("sse4.2") &&
+        __builtin_cpu_supports("popcnt")) {
+        static constexpr ByteKernels kernels{
+            "avx2",
+            detail::avx2::to_upper,
+            detail::avx2::to_lower,
+            detail::avx2::filter_printable,
+            detail::avx2::count_class,
+            detail::avx2::count_byte,
+            detail::sse42::crc32c,
+        };
+        return &kernels;
+    }
+#endif
+    return nullptr;
+}
+
+inline const ByteKernels& byte_kernels() {
+    static const ByteKernels& selected = []() -> const ByteKernels& {
+        for (std::string_view isa : {"avx2", "sse4.2"}) {
+            if (const ByteKernels* kernels = byte_kernels_for(isa)) {
+                return *kernels;
+            }
+        }
+        return scalar_byte_kernels();
+    }();
+    return selected;
+}
+
+// ============================================================================
+// CRC COMBINATION: crc(A + B) from crc(A), crc(B) and the length of B, so
+// chunks can be checksummed independently and joined in order
+// ============================================================================
+
+namespace detail {
+
+// a * b modulo the CRC polynomial, bit-reflected
+inline std::uint32_t crc32c_multiply(std::uint32_t a, std::uint32_t b) {
+    std::uint32_t m = std::uint32_t{1} << 31;
+    std::uint32_t product = 0;
+    for (;;) {
+        if (a & m) {
+            product ^= b;
+            if ((a & (m - 1)) == 0) {
+                break;
+            }
+        }
+        m >>= 1;
+        b = b & 1 ? (b >> 1) ^ scalar::kCrc32cPolynomial : b >> 1;
+    }
+    return product;
+}
+
+// x^(8 * bytes) modulo the CRC polynomial
+inline std::uint32_t crc32c_shift(std::uint64_t bytes) {
+    std::uint32_t result = std::uint32_t{1} << 31; // x^0
+    std::uint32_t square = std::uint32_t{1} << 23; // x^8
+    for (; bytes; bytes >>= 1) {
+        if (bytes & 1) {
+            result = crc32c_multiply(square, result);
+        }
+        square = crc32c_multiply(square, square);
+    }
+    return result;
+}
+
+}
+
+inline std::uint32_t crc32c_combine(std::uint32_t crc_a, std::uint32_t crc_b, std::uint64_t length_b) {
+    return detail::crc32c_multiply(detail::crc32c_shift(length_b), crc_a) ^ crc_b;
+}
+
+// ============================================================================
+// BYTE TRANSFORMS: the kernels as named, configurable operations. Mapping
+// transforms produce bytes; reducing ones produce a single number that
+// partial results of consecutive pieces combine into.
+// ============================================================================
+
+enum class ByteTransform : std::uint8_t {
+    Upper,
+    Lower,
+    Filter,       // drops control and non-ASCII bytes except \n and \t
+    CountDigits,
+    CountAlpha,
+    CountSpace,
+    CountLines,
+    Checksum      // CRC-32C
+};
+
+inline constexpr std::pair<std::string_view, ByteTransform> kByteTransformNames[] = {
+    {"upper", ByteTransform::Upper},
+    {"lower", ByteTransform::Lower},
+    {"filter", ByteTransform::Filter},
+    {"count_digits", ByteTransform::CountDigits},
+    {"count_alpha", ByteTransform::CountAlpha},
+    {"count_space", ByteTransform::CountSpace},
+    {"count_lines", ByteTransform::CountLines},
+    {"checksum", ByteTransform::Checksum},
+};
+
+inline std::optional<ByteTransform> parse_byte_transform(std::string_view name) {
+    for (const auto& [candidate, transform] : kByteTransformNames) {
+        if (candidate == name) {
+            return transform;
+        }
+    }
+    return std::nullopt;
+}
+
+inline std::string_view byte_transform_name(ByteTransform transform) {
+    for (const auto& [name, candidate] : kByteTransformNames) {
+        if (candidate == transform) {
+            return name;
+        }
+    }
+    return "unknown";
+}
+
+inline bool is_reduction(ByteTransform transform) {
+    return transform >= ByteTransform::CountDigits;
+}
+
+// Appends the mapped bytes of in to out
+inline void map_bytes(ByteTransform transform, std::string_view in, std::string& out,
+                      const ByteKernels& kernels = byte_kernels()) {
+    size_t start = out.size();
+    out.resize(start + in.size());
+    char* target = out.data() + start;
+    switch (transform) {
+        case ByteTransform::Upper:
+            kernels.to_upper(in.data(), in.size(), target);
+            break;
+        case ByteTransform::Lower:
+            kernels.to_lower(in.data(), in.size(), target);
+            break;
+        case ByteTransform::Filter:
+            out.resize(start + kernels.filter_printable(in.data(), in.size(), target));
+            break;
+        default:
+            out.resize(start);
+            break;
+    }
+}
+
+struct ByteReduction {
+    std::uint64_t value = 0;
+    std::uint64_t length = 0; // bytes covered
+};
+
+inline ByteReduction reduce_bytes(ByteTransform transform, std::string_view in,
+                                  const ByteKernels& kernels = byte_kernels()) {
+    ByteReduction result{0, in.size()};
+    switch (transform) {
+        case ByteTransform::CountDigits:
+            result.value = kernels.count_class(in.data(), in.size(), CharClass::Digit);
+            break;
+        case ByteTransform::CountAlpha:
+            result.value = kernels.count_class(in.data(), in.size(), CharClass::Alpha);
+            break;
+        case ByteTransform::CountSpace:
+            result.value = kernels.count_class(in.data(), in.size(), CharClass::Space);
+            break;
+        case ByteTransform::CountLines:
+            result.value = kernels.count_byte(in.data(), in.size(), '\n');
+            break;
+        case ByteTransform::Checksum:
+            result.value = kernels.crc32c(0, in.data(), in.size());
+            break;
+        default:
+            break;
+    }
+    return result;
+}
+
+// The reduction of a followed by b
+inline ByteReduction combine_reductions(ByteTransform transform, ByteReduction a, ByteReduction b) {
+    if (transform == ByteTransform::Checksum) {
+        return {crc32c_combine(static_cast<std::uint32_t>(a.value), static_cast<std::uint32_t>(b.value), b.length),
+                a.length + b.length};
+    }
+    return {a.value + b.value, a.length + b.length};
+}
+
+}
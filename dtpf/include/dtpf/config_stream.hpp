@@ -0,0 +1,192 @@
+// Streaming config ingestion: task blocks are handed on as soon as each one
+// closes, and run while the rest of the file is still being parsed
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "dtpf/config_syntax.hpp"
+#include "dtpf/mapped_file.hpp"
+#include "dtpf/result_stream.hpp"
+#include "dtpf/task_config.hpp"
+
+namespace dtpf {
+
+// The TaskConfig a task statement describes
+inline TaskConfig make_task_config(const ConfigStatement& statement) {
+    TaskConfig task_config;
+    task_config.type = statement.name;
+    for (size_t i = 0; i < statement.properties.size(); ++i) {
+        auto [key, value] = statement.properties[i];
+        task_config.properties[std::string(key)] = value;
+
+        // Handle special properties
+        if (key == "priority") {
+            task_config.priority = ConfigStatementParser::to_int(statement.values[i], key);
+        } else if (key == "node") {
+            task_config.node_assignment = value;
+        }
+    }
+    return task_config;
+}
+
+// ============================================================================
+// CONFIG TASK READER: pulls task blocks from a mapped config file in file
+// order. Other statements are still parsed, so a syntax error anywhere is
+// reported, but are skipped. Pages behind the parse position are handed
+// back every release_bytes, so resident memory stays bounded however large
+// the file is.
+// ============================================================================
+
+class ConfigTaskReader {
+public:
+    explicit ConfigTaskReader(const std::string& path, size_t release_bytes = 4 * 1024 * 1024)
+        : file_(path), parser_(file_.data()), release_bytes_(std::max<size_t>(release_bytes, 1)) {}
+
+    // nullopt at the end of the file; throws ConfigSyntaxError
+    std::optional<TaskConfig> next() {
+        while (parser_.next(statement_)) {
+            if (statement_.kind == ConfigStatement::Kind::Task) {
+                // statement_ views the mapped pages, so copy it out before they go
+                TaskConfig config = make_task_config(statement_);
+                release_consumed();
+                return config;
+            }
+            release_consumed();
+        }
+        file_.release(released_, file_.size() - released_);
+        released_ = file_.size();
+        return std::nullopt;
+    }
+
+    size_t bytes_read() const { return parser_.position(); }
+    size_t size() const { return file_.size(); }
+
+private:
+    MappedFile file_; // declared before parser_, which views its data
+    ConfigStatementParser parser_;
+    ConfigStatement statement_;
+    size_t release_bytes_;
+    size_t released_ = 0;
+
+    void release_consumed() {
+        size_t consumed = parser_.position();
+        if (consumed - released_ >= release_bytes_) {
+            file_.release(released_, consumed - released_);
+            released_ = consumed;
+        }
+    }
+};
+
+// ============================================================================
+// STREAMING EXECUTION: a reader thread parses the file into a bounded queue
+// of configs, max_in_flight workers run them as they arrive, and results
+// come back through a second bounded queue. Execution starts once the first
+// block closes, and at most queue_capacity configs, max_in_flight running
+// tasks and buffer_capacity results are alive at a time.
+// ============================================================================
+
+struct ConfigStreamOptions {
+    size_t max_in_flight = std::thread::hardware_concurrency(); // tasks executing at once
+    size_t queue_capacity = 1024;                               // parsed configs awaiting a worker
+    size_t buffer_capacity = 64;                                // finished results awaiting delivery
+    size_t release_bytes = 4 * 1024 * 1024;                     // parsed input dropped in steps of this
+};
+
+// run(TaskConfig&&) runs on the workers; on_result(size_t index, Result)
+// receives each result on the calling thread in completion order, with the
+// task's position among the file's task blocks. A syntax error stops the
+// reader: tasks before it still run, then the error is rethrown. Returns
+// the number of tasks read.
+template<typename Run, typename OnResult>
+size_t stream_config_file(const std::string& path, Run&& run, OnResult&& on_result,
+                          const ConfigStreamOptions& options = {}) {
+    using Result = std::invoke_result_t<Run&, TaskConfig&&>;
+    ConfigTaskReader reader(path, options.release_bytes);
+    BoundedQueue<std::pair<size_t, TaskConfig>> pending(options.queue_capacity);
+    BoundedQueue<std::pair<size_t, Result>> completed(options.buffer_capacity);
+
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto fail = [&] {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) {
+            error = std::current_exception();
+        }
+    };
+
+    size_t read = 0;
+    std::thread reader_thread([&] {
+        try {
+            while (auto config = reader.next()) {
+                if (!pending.push({read, std::move(*config)})) {
+                    break; // consumer gave up
+                }
+                ++read;
+            }
+        } catch (...) {
+            fail();
+        }
+        pending.close(); // workers drain what was queued
+    });
+
+    // The last worker out closes the result queue
+    size_t worker_count = std::max<size_t>(options.max_in_flight, 1);
+    std::atomic<size_t> running{worker_count};
+    std::vector<std::thread> workers;
+    workers.reserve(worker_count);
+    for (size_t w = 0; w < worker_count; ++w) {
+        workers.emplace_back([&] {
+            try {
+                while (auto item = pending.pop()) {
+                    if (!completed.push({item->first, run(std::move(item->second))})) {
+                        break;
+                    }
+                }
+            } catch (...) {
+                fail();
+                pending.close();
+            }
+            if (--running == 0) {
+                completed.close();
+            }
+        });
+    }
+
+    bool consumer_failed = false;
+    while (auto item = completed.pop()) {
+        try {
+            on_result(item->first, std::move(item->second));
+        } catch (...) {
+            fail();
+            consumer_failed = true;
+            break;
+        }
+    }
+
+    if (consumer_failed) {
+        pending.close();
+        completed.close();
+    }
+    reader_thread.join();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return read;
+}
+
+}
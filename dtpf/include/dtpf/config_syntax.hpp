@@ -0,0 +1,409 @@
+// Single-pass lexer and recursive-descent parser for the configuration language
+
+#pragma once
+
+#include <cctype>
+#include <charconv>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace dtpf {
+
+// ============================================================================
+// GRAMMAR
+//
+//   config     := { statement }
+//   statement  := "task" ":" WORD block
+//               | "node" ":" WORD block
+//               | "route" ":" WORD "->" WORD [ "where" LINE ]
+//               | "pipeline" ":" LINE            stages separated by "->"
+//               | WORD "{" ANY "}"               other sections, skipped
+//   block      := "{" { WORD "=" STRING [ ";" | "," ] } "}"
+//
+// WORD is [A-Za-z0-9_]+. STRING is double-quoted, without escapes, and may
+// span lines. LINE is the raw rest of the line, trimmed. ANY is any text in
+// which braces outside strings are balanced. Outside strings and LINE text,
+// '#' and "//" start comments that run to the end of the line.
+// ============================================================================
+
+class ConfigSyntaxError : public std::runtime_error {
+public:
+    ConfigSyntaxError(size_t line, size_t column, const std::string& message)
+        : std::runtime_error("line " + std::to_string(line) + ", column " + std::to_string(column) + ": " + message),
+          line_(line), column_(column) {}
+
+    size_t line() const { return line_; }
+    size_t column() const { return column_; }
+
+private:
+    size_t line_;
+    size_t column_;
+};
+
+struct ConfigToken {
+    enum class Kind { Word, String, Colon, LeftBrace, RightBrace, Equals, Arrow, Separator, End };
+
+    Kind kind = Kind::End;
+    std::string_view text; // a string's contents, without the quotes
+    size_t line = 1;
+    size_t column = 1;
+};
+
+// ============================================================================
+// LEXER: tokens are views into the input. Positions are 1-based; columns
+// count bytes.
+// ============================================================================
+
+class ConfigLexer {
+public:
+    explicit ConfigLexer(std::string_view input) : input_(input) {}
+
+    ConfigToken next() {
+        skip_blanks();
+        ConfigToken token{ConfigToken::Kind::End, {}, line_, column()};
+        if (position_ >= input_.size()) {
+            return token;
+        }
+        size_t start = position_;
+        char c = input_[position_];
+        if (is_word(c)) {
+            while (position_ < input_.size() && is_word(input_[position_])) {
+                ++position_;
+            }
+            token.kind = ConfigToken::Kind::Word;
+            token.text = input_.substr(start, position_ - start);
+            return token;
+        }
+        if (c == '"') {
+            size_t close = input_.find('"', start + 1);
+            if (close == std::string_view::npos) {
+                throw ConfigSyntaxError(token.line, token.column, "unterminated string");
+            }
+            token.kind = ConfigToken::Kind::String;
+            token.text = input_.substr(start + 1, close - start - 1);
+            advance_to(close + 1);
+            return token;
+        }
+        if (c == '-' && input_.substr(start, 2) == "->") {
+            position_ += 2;
+            token.kind = ConfigToken::Kind::Arrow;
+            token.text = input_.substr(start, 2);
+            return token;
+        }
+        switch (c) {
+            case ':': token.kind = ConfigToken::Kind::Colon; break;
+            case '{': token.kind = ConfigToken::Kind::LeftBrace; break;
+            case '}': token.kind = ConfigToken::Kind::RightBrace; break;
+            case '=': token.kind = ConfigToken::Kind::Equals; break;
+            case ';':
+            case ',': token.kind = ConfigToken::Kind::Separator; break;
+            default:
+                throw ConfigSyntaxError(token.line, token.column, "unexpected character '" + std::string(1, c) + "'");
+        }
+        ++position_;
+        token.text = input_.substr(start, 1);
+        return token;
+    }
+
+    // The raw text up to the end of the line, trimmed, with its position
+    ConfigToken rest_of_line() {
+        while (position_ < input_.size() && (input_[position_] == ' ' || input_[position_] == '\t')) {
+            ++position_;
+        }
+        ConfigToken token{ConfigToken::Kind::String, {}, line_, column()};
+        size_t end = input_.find('\n', position_);
+        if (end == std::string_view::npos) {
+            end = input_.size();
+        }
+        token.text = trim(input_.substr(position_, end - position_));
+        position_ = end;
+        return token;
+    }
+
+    // Skips blanks and comments; true when the next token would be word
+    bool next_is_word(std::string_view word) {
+        skip_blanks();
+        return input_.substr(position_, word.size()) == word &&
+               (position_ + word.size() == input_.size() || !is_word(input_[position_ + word.size()]));
+    }
+
+    // Moves past the '}' closing a block whose '{' was just read, without
+    // tokenizing what is inside; braces within quoted strings do not count.
+    // False when the block is never closed.
+    bool skip_block() {
+        size_t depth = 1;
+        for (size_t i = position_; i < input_.size(); ++i) {
+            if (input_[i] == '"') {
+                i = input_.find('"', i + 1);
+                if (i == std::string_view::npos) {
+                    return false;
+                }
+            } else if (input_[i] == '{') {
+                ++depth;
+            } else if (input_[i] == '}' && --depth == 0) {
+                advance_to(i + 1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Bytes consumed so far
+    size_t position() const { return position_; }
+
+    static std::string_view trim(std::string_view text) {
+        size_t begin = text.find_first_not_of(" \t\r\n");
+        if (begin == std::string_view::npos) {
+            return {};
+        }
+        return text.substr(begin, text.find_last_not_of(" \t\r\n") - begin + 1);
+    }
+
+private:
+    std::string_view input_;
+    size_t position_ = 0;
+    size_t line_ = 1;
+    size_t line_start_ = 0;
+
+    static bool is_word(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    size_t column() const { return position_ - line_start_ + 1; }
+
+    void newline_at(size_t position) {
+        ++line_;
+        line_start_ = position + 1;
+    }
+
+    // Moves past text that may hold newlines, keeping the line count
+    void advance_to(size_t end) {
+        for (size_t i = input_.find('\n', position_); i < end; i = input_.find('\n', i + 1)) {
+            newline_at(i);
+        }
+        position_ = end;
+    }
+
+    void skip_blanks() {
+        while (position_ < input_.size()) {
+            char c = input_[position_];
+            if (c == '\n') {
+                newline_at(position_++);
+            } else if (c == ' ' || c == '\t' || c == '\r') {
+                ++position_;
+            } else if (c == '#' || (c == '/' && input_.substr(position_, 2) == "//")) {
+                size_t end = input_.find('\n', position_);
+                position_ = end == std::string_view::npos ? input_.size() : end;
+            } else {
+                break;
+            }
+        }
+    }
+};
+
+// ============================================================================
+// STATEMENT PARSER: pulls one statement at a time. The statement's fields
+// are views into the input and its vectors are reused from call to call, so
+// a large config is parsed without per-statement allocation once the
+// vectors have grown.
+// ============================================================================
+
+struct ConfigStatement {
+    enum class Kind { Task, Node, Route, Pipeline };
+
+    Kind kind = Kind::Task;
+    std::string_view name; // task type or node name
+    std::vector<std::pair<std::string_view, std::string_view>> properties;
+    std::vector<ConfigToken> values; // the value token of each property, for error positions
+    std::string_view from;
+    std::string_view to;
+    std::string_view condition; // empty when the route has no where clause
+    std::vector<std::string_view> stages;
+    size_t line = 1;
+    size_t column = 1;
+};
+
+class ConfigStatementParser {
+public:
+    explicit ConfigStatementParser(std::string_view input) : lexer_(input) {}
+
+    // False at the end of the input. Other sections, such as "global { ... }",
+    // are skipped and left to ConfigParser::extract_section.
+    bool next(ConfigStatement& out) {
+        for (;;) {
+            ConfigToken keyword = lexer_.next();
+            if (keyword.kind == ConfigToken::Kind::End) {
+                return false;
+            }
+            out.properties.clear();
+            out.values.clear();
+            out.stages.clear();
+            out.name = out.from = out.to = out.condition = {};
+            out.line = keyword.line;
+            out.column = keyword.column;
+
+            if (keyword.kind == ConfigToken::Kind::Word && keyword.text == "task") {
+                out.kind = ConfigStatement::Kind::Task;
+                parse_block_statement(out);
+            } else if (keyword.kind == ConfigToken::Kind::Word && keyword.text == "node") {
+                out.kind = ConfigStatement::Kind::Node;
+                parse_block_statement(out);
+            } else if (keyword.kind == ConfigToken::Kind::Word && keyword.text == "route") {
+                out.kind = ConfigStatement::Kind::Route;
+                parse_route(out);
+            } else if (keyword.kind == ConfigToken::Kind::Word && keyword.text == "pipeline") {
+                out.kind = ConfigStatement::Kind::Pipeline;
+                parse_pipeline(out);
+            } else if (keyword.kind == ConfigToken::Kind::Word && lexer_.next().kind == ConfigToken::Kind::LeftBrace) {
+                if (!lexer_.skip_block()) {
+                    std::string message("unterminated '");
+                    message.append(keyword.text).append("' section");
+                    fail(keyword, message);
+                }
+                continue;
+            } else {
+                fail(keyword, "expected task, node, route or pipeline");
+            }
+            return true;
+        }
+    }
+
+    // Everything before this offset belongs to statements already returned
+    size_t position() const { return lexer_.position(); }
+
+    // Integer property values, reported at the value's position when malformed
+    static int to_int(const ConfigToken& value, std::string_view key) {
+        int result = 0;
+        auto [end, error] = std::from_chars(value.text.data(), value.text.data() + value.text.size(), result);
+        if (error != std::errc{} || end != value.text.data() + value.text.size() || value.text.empty()) {
+            std::string message(1, '\'');
+            message.append(key).append("' must be an integer");
+            fail(value, message);
+        }
+        return result;
+    }
+
+private:
+    ConfigLexer lexer_;
+
+    [[noreturn]] static void fail(const ConfigToken& token, const std::string& message) {
+        throw ConfigSyntaxError(token.line, token.column, message);
+    }
+
+    static std::string describe(const ConfigToken& token) {
+        if (token.kind == ConfigToken::Kind::End) {
+            return "end of input";
+        }
+        std::string quoted(1, '\'');
+        quoted.append(token.text).push_back('\'');
+        return quoted;
+    }
+
+    ConfigToken expect(ConfigToken::Kind kind, const char* what) {
+        ConfigToken token = lexer_.next();
+        if (token.kind != kind) {
+            fail(token, std::string("expected ") + what + ", found " + describe(token));
+        }
+        return token;
+    }
+
+    void parse_block_statement(ConfigStatement& out) {
+        expect(ConfigToken::Kind::Colon, "':'");
+        out.name = expect(ConfigToken::Kind::Word, "a name").text;
+        expect(ConfigToken::Kind::LeftBrace, "'{'");
+        for (;;) {
+            ConfigToken token = lexer_.next();
+            if (token.kind == ConfigToken::Kind::RightBrace) {
+                return;
+            }
+            if (token.kind == ConfigToken::Kind::Separator) {
+                continue;
+            }
+            if (token.kind != ConfigToken::Kind::Word) {
+                fail(token, "expected a property name or '}', found " + describe(token));
+            }
+            expect(ConfigToken::Kind::Equals, "'='");
+            ConfigToken value = expect(ConfigToken::Kind::String, "a quoted value");
+            out.properties.emplace_back(token.text, value.text);
+            out.values.push_back(value);
+        }
+    }
+
+    void parse_route(ConfigStatement& out) {
+        expect(ConfigToken::Kind::Colon, "':'");
+        out.from = expect(ConfigToken::Kind::Word, "a source node").text;
+        expect(ConfigToken::Kind::Arrow, "'->'");
+        out.to = expect(ConfigToken::Kind::Word, "a target node").text;
+        if (lexer_.next_is_word("where")) {
+            lexer_.next();
+            ConfigToken condition = lexer_.rest_of_line();
+            if (condition.text.empty()) {
+                fail(condition, "expected a condition after 'where'");
+            }
+            out.condition = condition.text;
+        }
+    }
+
+    void parse_pipeline(ConfigStatement& out) {
+        expect(ConfigToken::Kind::Colon, "':'");
+        ConfigToken line = lexer_.rest_of_line();
+        std::string_view rest = line.text;
+        while (!rest.empty()) {
+            size_t arrow = rest.find("->");
+            std::string_view stage = ConfigLexer::trim(rest.substr(0, arrow));
+            if (!stage.empty()) {
+                out.stages.push_back(stage);
+            }
+            rest = arrow == std::string_view::npos ? std::string_view{} : rest.substr(arrow + 2);
+        }
+        if (out.stages.empty()) {
+            fail(line, "expected pipeline stages");
+        }
+    }
+};
+
+// ============================================================================
+// ROUTE CONDITIONS: "field op value", where field and value are words and op
+// is a run of <, >, = and !, becomes a pattern for std::regex_search. Any
+// other condition is used as a pattern as it stands.
+// ============================================================================
+
+inline std::string condition_to_pattern(std::string_view condition) {
+    auto is_word = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; };
+    auto is_op = [](char c) { return c == '<' || c == '>' || c == '=' || c == '!'; };
+    auto is_space = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+    auto span = [&](size_t& at, auto&& accept) {
+        size_t start = at;
+        while (at < condition.size() && accept(condition[at])) {
+            ++at;
+        }
+        return std::string(condition.substr(start, at - start));
+    };
+
+    size_t at = 0;
+    std::string field = span(at, is_word);
+    span(at, is_space);
+    std::string op = span(at, is_op);
+    span(at, is_space);
+    std::string value = span(at, is_word);
+    if (!field.empty() && !op.empty() && !value.empty() && at == condition.size()) {
+        if (op == "==" || op == "=") {
+            return field + R"(\s*:\s*)" + value;
+        } else if (op == "!=") {
+            // Anchored, so the search cannot succeed by starting past the
+            // match; [\s\S] also looks across lines
+            return R"(^(?![\s\S]*)" + field + R"(\s*:\s*)" + value + ")";
+        } else if (op == ">") {
+            // For numeric comparisons, this is simplified
+            return field + R"(\s*:\s*[0-9]+)";
+        }
+    }
+    return std::string(condition);
+}
+
+}
@@ -0,0 +1,120 @@
+// Linear-time stable orderings of integer keys, split across threads
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace dtpf {
+
+// ============================================================================
+// COUNTING SORT: task keys such as priorities and interned type ids span a
+// small range, so ordering them needs no comparisons. One pass counts each
+// key and one pass scatters indices to their final slots. Keys spanning more
+// than kCountingRange values take two stable 16-bit radix passes. Large
+// inputs are cut into one contiguous slice per thread. Each slice counts and
+// scatters its own elements, and slices fill every bucket in input order, so
+// the parallel result is still stable.
+// ============================================================================
+
+struct CountingSortOptions {
+    size_t threads = std::thread::hardware_concurrency();
+    size_t parallel_threshold = size_t{1} << 17; // fewer keys sort on one thread
+};
+
+namespace detail {
+
+inline constexpr size_t kCountingRange = size_t{1} << 16;
+
+template<typename Body>
+void for_each_slice(size_t slices, Body&& body) {
+    std::vector<std::thread> workers;
+    for (size_t s = 1; s < slices; ++s) {
+        workers.emplace_back(body, s);
+    }
+    body(size_t{0});
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// One stable pass: out receives source(i) for every i in 0..n, ordered by
+// digit(i), which must be below digit_limit
+template<typename Digit, typename Source>
+void counting_pass(size_t n, size_t digit_limit, Digit&& digit, Source&& source, std::uint32_t* out,
+                   const CountingSortOptions& options) {
+    size_t slices = n < options.parallel_threshold ? 1 : std::clamp<size_t>(options.threads, 1, 64);
+    size_t slice_size = (n + slices - 1) / slices;
+    std::vector<size_t> offsets(slices * digit_limit, 0); // counts, then first slot per slice and digit
+
+    for_each_slice(slices, [&](size_t s) {
+        size_t* counts = offsets.data() + s * digit_limit;
+        for (size_t i = s * slice_size, end = std::min(n, i + slice_size); i < end; ++i) {
+            ++counts[digit(i)];
+        }
+    });
+    size_t next = 0;
+    for (size_t d = 0; d < digit_limit; ++d) {
+        for (size_t s = 0; s < slices; ++s) {
+            size_t count = offsets[s * digit_limit + d];
+            offsets[s * digit_limit + d] = next;
+            next += count;
+        }
+    }
+    for_each_slice(slices, [&](size_t s) {
+        size_t* slots = offsets.data() + s * digit_limit;
+        for (size_t i = s * slice_size, end = std::min(n, i + slice_size); i < end; ++i) {
+            out[slots[digit(i)]++] = source(i);
+        }
+    });
+}
+
+}
+
+// order[k] is the index of the k-th smallest key; equal keys keep their input order
+inline std::vector<std::uint32_t> stable_key_order(std::span<const std::uint32_t> keys,
+                                                   const CountingSortOptions& options = {}) {
+    if (keys.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error("Too many keys to order with 32-bit indices");
+    }
+    std::vector<std::uint32_t> order(keys.size());
+    if (keys.empty()) {
+        return order;
+    }
+    auto [low, high] = std::minmax_element(keys.begin(), keys.end());
+    const std::uint32_t min = *low;
+    const size_t range = size_t{*high} - min + 1;
+    auto index = [](size_t i) { return static_cast<std::uint32_t>(i); };
+
+    if (range <= detail::kCountingRange) {
+        detail::counting_pass(keys.size(), range, [&](size_t i) { return keys[i] - min; },
+                              index, order.data(), options);
+        return order;
+    }
+
+    std::vector<std::uint32_t> by_low(keys.size());
+    detail::counting_pass(keys.size(), detail::kCountingRange,
+                          [&](size_t i) { return (keys[i] - min) & 0xFFFF; },
+                          index, by_low.data(), options);
+    detail::counting_pass(keys.size(), ((range - 1) >> 16) + 1,
+                          [&](size_t k) { return (keys[by_low[k]] - min) >> 16; },
+                          [&](size_t k) { return by_low[k]; }, order.data(), options);
+    return order;
+}
+
+// Signed keys in their natural order, or reversed, as unsigned sort keys
+inline std::uint32_t ascending_key(std::int32_t value) {
+    return static_cast<std::uint32_t>(value) ^ 0x8000'0000u;
+}
+
+inline std::uint32_t descending_key(std::int32_t value) {
+    return ~ascending_key(value);
+}
+
+}
@@ -0,0 +1,88 @@
+// Deadline bookkeeping shared by the scheduler and the execution engine
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace dtpf {
+
+using DeadlineClock = std::chrono::steady_clock;
+
+// What to do with a task that can no longer finish before its deadline
+enum class DeadlineAdmission {
+    Reject, // fail it immediately
+    Demote  // run it later as best-effort batch work
+};
+
+// ============================================================================
+// DEADLINE METRICS
+// ============================================================================
+
+class DeadlineMetrics {
+public:
+    struct Snapshot {
+        std::uint64_t admitted = 0;
+        std::uint64_t rejected = 0;
+        std::uint64_t demoted = 0;
+        std::uint64_t met = 0;
+        std::uint64_t missed = 0;
+
+        // Share of deadline-bearing tasks that did not finish on time,
+        // counting rejected and demoted tasks as misses
+        double miss_rate() const {
+            std::uint64_t failed = missed + rejected + demoted;
+            std::uint64_t total = met + failed;
+            return total == 0 ? 0.0 : static_cast<double>(failed) / static_cast<double>(total);
+        }
+    };
+
+    void record_admitted() { admitted_.fetch_add(1, std::memory_order_relaxed); }
+    void record_rejected() { rejected_.fetch_add(1, std::memory_order_relaxed); }
+    void record_demoted() { demoted_.fetch_add(1, std::memory_order_relaxed); }
+
+    void record_completion(DeadlineClock::time_point deadline) {
+        if (DeadlineClock::now() <= deadline) {
+            met_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            missed_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    Snapshot snapshot() const {
+        return Snapshot{
+            admitted_.load(std::memory_order_relaxed),
+            rejected_.load(std::memory_order_relaxed),
+            demoted_.load(std::memory_order_relaxed),
+            met_.load(std::memory_order_relaxed),
+            missed_.load(std::memory_order_relaxed)
+        };
+    }
+
+    double miss_rate() const {
+        return snapshot().miss_rate();
+    }
+
+    void reset() {
+        admitted_ = 0;
+        rejected_ = 0;
+        demoted_ = 0;
+        met_ = 0;
+        missed_ = 0;
+    }
+
+private:
+    std::atomic<std::uint64_t> admitted_{0};
+    std::atomic<std::uint64_t> rejected_{0};
+    std::atomic<std::uint64_t> demoted_{0};
+    std::atomic<std::uint64_t> met_{0};
+    std::atomic<std::uint64_t> missed_{0};
+};
+
+// Returns true when a task estimated to take `cost` can still finish in time
+inline bool can_meet_deadline(DeadlineClock::time_point deadline, DeadlineClock::duration cost) {
+    return DeadlineClock::now() + cost <= deadline;
+}
+
+}
@@ -0,0 +1,340 @@
+// Lock-free structured event log for hot-path instrumentation
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Compile-time ceiling for event verbosity: 0 compiles every call site away
+#ifndef DTPF_LOG_LEVEL
+#define DTPF_LOG_LEVEL 4
+#endif
+
+namespace dtpf {
+
+// ============================================================================
+// EVENT TYPES
+// ============================================================================
+
+enum class LogLevel : std::uint8_t {
+    Off = 0,
+    Error = 1,
+    Info = 2,
+    Debug = 3,
+    Trace = 4
+};
+
+inline constexpr LogLevel kCompiledLogLevel = static_cast<LogLevel>(DTPF_LOG_LEVEL);
+
+enum class EventKind : std::uint8_t {
+    Message,        // label
+    StrategyBegin,  // label = strategy name, a = task count
+    StrategyChoice, // label = reason
+    TaskStart,      // a = index, b = total, label = task type
+    TaskWait,       // a = index, b = total
+    TaskAssign,     // a = index, label = node id
+    TaskCollect,    // a = index
+    PipelineStage   // a = index, b = total, label = task type
+};
+
+// Fixed-size POD record so that producers never allocate
+struct Event {
+    std::int64_t timestamp_ns = 0;
+    std::uint32_t a = 0;
+    std::uint32_t b = 0;
+    EventKind kind = EventKind::Message;
+    LogLevel level = LogLevel::Info;
+    std::uint8_t label_size = 0;
+    char label[45] = {};
+
+    std::string_view label_view() const {
+        return std::string_view(label, label_size);
+    }
+};
+
+static_assert(sizeof(Event) == 64, "Event should occupy exactly one cache line");
+
+inline std::string format_event(const Event& event) {
+    std::string line;
+    switch (event.kind) {
+        case EventKind::StrategyBegin:
+            line = "  → " + std::string(event.label_view()) + " execution of "
+                 + std::to_string(event.a) + " tasks";
+            break;
+        case EventKind::StrategyChoice:
+            line = "    Adaptive choice: " + std::string(event.label_view());
+            break;
+        case EventKind::TaskStart:
+            line = "    Executing task " + std::to_string(event.a + 1) + "/" + std::to_string(event.b)
+                 + " (" + std::string(event.label_view()) + ")";
+            break;
+        case EventKind::TaskWait:
+            line = "    Waiting for task " + std::to_string(event.a + 1) + "/" + std::to_string(event.b);
+            break;
+        case EventKind::TaskAssign:
+            line = "    Assigning task " + std::to_string(event.a + 1) + " to "
+                 + std::string(event.label_view());
+            break;
+        case EventKind::TaskCollect:
+            line = "    Collecting result from distributed task " + std::to_string(event.a + 1);
+            break;
+        case EventKind::PipelineStage:
+            line = "    Pipeline stage " + std::to_string(event.a + 1) + "/" + std::to_string(event.b)
+                 + " (" + std::string(event.label_view()) + ")";
+            break;
+        default:
+            line = std::string(event.label_view());
+            break;
+    }
+    return line;
+}
+
+// ============================================================================
+// PER-THREAD RING BUFFER: single producer, single consumer (the drainer)
+// ============================================================================
+
+class EventRing {
+public:
+    static constexpr size_t kCapacity = 1024;
+    static_assert((kCapacity & (kCapacity - 1)) == 0, "Capacity must be a power of two");
+
+    bool try_push(const Event& event) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        if (head - tail == kCapacity) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        slots_[head & (kCapacity - 1)] = event;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<typename F>
+    size_t drain(F&& consume) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_acquire);
+        size_t count = head - tail;
+        for (; tail != head; ++tail) {
+            consume(slots_[tail & (kCapacity - 1)]);
+        }
+        tail_.store(tail, std::memory_order_release);
+        return count;
+    }
+
+    std::uint64_t dropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::array<Event, kCapacity> slots_;
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+};
+
+// ============================================================================
+// EVENT LOG: per-thread rings drained by a background thread into a sink
+// ============================================================================
+
+class EventLog {
+public:
+    using Sink = std::function<void(const Event&)>;
+
+    static EventLog& instance() {
+        static EventLog log;
+        return log;
+    }
+
+    ~EventLog() {
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex_);
+            stop_ = true;
+        }
+        wakeup_.notify_all();
+        if (drainer_.joinable()) {
+            drainer_.join();
+        }
+        flush();
+    }
+
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    void set_level(LogLevel level) {
+        runtime_level_.store(level, std::memory_order_relaxed);
+    }
+
+    LogLevel level() const {
+        return runtime_level_.load(std::memory_order_relaxed);
+    }
+
+    void set_sink(Sink sink) {
+        std::lock_guard<std::mutex> lock(drain_mutex_);
+        sink_ = std::move(sink);
+    }
+
+    void set_drain_interval(std::chrono::milliseconds interval) {
+        drain_interval_ns_.store(std::chrono::nanoseconds(interval).count(), std::memory_order_relaxed);
+    }
+
+    static constexpr bool compiled(LogLevel level) {
+        return level != LogLevel::Off && level <= kCompiledLogLevel;
+    }
+
+    static bool enabled(LogLevel level) {
+        return compiled(level) && level <= instance().level();
+    }
+
+    // Hot path: a relaxed load, a clock read and a copy into the thread's ring
+    template<LogLevel Level>
+    static void emit(EventKind kind, size_t a = 0, size_t b = 0, std::string_view label = {}) {
+        if constexpr (!compiled(Level)) {
+            return;
+        } else {
+            EventLog& log = instance();
+            if (Level > log.level()) {
+                return;
+            }
+
+            Event event;
+            event.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            event.a = static_cast<std::uint32_t>(a);
+            event.b = static_cast<std::uint32_t>(b);
+            event.kind = kind;
+            event.level = Level;
+            event.label_size = static_cast<std::uint8_t>(std::min(label.size(), sizeof(event.label)));
+            std::memcpy(event.label, label.data(), event.label_size);
+
+            log.local_ring().try_push(event);
+        }
+    }
+
+    // Drain every ring synchronously, delivering events in timestamp order
+    void flush() {
+        std::lock_guard<std::mutex> drain_lock(drain_mutex_);
+        std::vector<std::shared_ptr<EventRing>> rings;
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex_);
+            rings = rings_;
+        }
+
+        pending_.clear();
+        for (auto& ring : rings) {
+            ring->drain([this](const Event& event) { pending_.push_back(event); });
+        }
+
+        std::stable_sort(pending_.begin(), pending_.end(),
+            [](const Event& a, const Event& b) { return a.timestamp_ns < b.timestamp_ns; });
+
+        for (const auto& event : pending_) {
+            if (sink_) {
+                sink_(event);
+            } else {
+                std::cout << format_event(event) << '\n';
+            }
+        }
+    }
+
+    std::uint64_t dropped_events() const {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        std::uint64_t total = 0;
+        for (const auto& ring : rings_) {
+            total += ring->dropped();
+        }
+        return total;
+    }
+
+private:
+    EventLog() = default;
+
+    // Hands the thread's ring back when the thread exits. Events still in
+    // it are drained as usual; the next thread to log reuses it.
+    struct RingLease {
+        EventRing* ring;
+
+        ~RingLease() {
+            EventLog::instance().release_ring(ring);
+        }
+    };
+
+    EventRing& local_ring() {
+        thread_local RingLease lease{acquire_ring()};
+        return *lease.ring;
+    }
+
+    // Cold path: runs once per thread. Rings are only added when none is
+    // free, so there are as many as the most threads that logged at once,
+    // however many threads come and go.
+    EventRing* acquire_ring() {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        if (!free_rings_.empty()) {
+            EventRing* ring = free_rings_.back();
+            free_rings_.pop_back();
+            return ring;
+        }
+        auto ring = std::make_shared<EventRing>();
+        rings_.push_back(ring);
+        if (!drainer_.joinable() && !stop_) {
+            drainer_ = std::thread([this] { drain_loop(); });
+        }
+        return ring.get();
+    }
+
+    // The registry mutex orders the old producer's pushes before the new one's
+    void release_ring(EventRing* ring) {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        free_rings_.push_back(ring);
+    }
+
+    void drain_loop() {
+        std::unique_lock<std::mutex> lock(registry_mutex_);
+        while (!stop_) {
+            auto interval = std::chrono::nanoseconds(drain_interval_ns_.load(std::memory_order_relaxed));
+            wakeup_.wait_for(lock, interval, [this] { return stop_; });
+            lock.unlock();
+            flush();
+            lock.lock();
+        }
+    }
+
+    std::atomic<LogLevel> runtime_level_{LogLevel::Info};
+    std::atomic<std::int64_t> drain_interval_ns_{5'000'000};
+
+    mutable std::mutex registry_mutex_;
+    std::vector<std::shared_ptr<EventRing>> rings_;
+    std::vector<EventRing*> free_rings_; // owned by rings_, left by exited threads
+    std::condition_variable wakeup_;
+    bool stop_ = false;
+    std::thread drainer_;
+
+    std::mutex drain_mutex_;
+    std::vector<Event> pending_;
+    Sink sink_;
+};
+
+}
+
+// Arguments are only evaluated when the level is both compiled in and enabled
+#define DTPF_EVENT(Level, ...) \
+    do { \
+        if constexpr (::dtpf::EventLog::compiled(::dtpf::LogLevel::Level)) { \
+            if (::dtpf::EventLog::enabled(::dtpf::LogLevel::Level)) { \
+                ::dtpf::EventLog::emit<::dtpf::LogLevel::Level>(__VA_ARGS__); \
+            } \
+        } \
+    } while (0)
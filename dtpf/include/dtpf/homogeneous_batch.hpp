@@ -0,0 +1,203 @@
+// Tasks grouped by concrete type and executed without virtual dispatch
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <span>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "dtpf/any_result.hpp"
+
+namespace dtpf {
+
+// Tasks whose work completes elsewhere, e.g. on an I/O reactor, expose
+// start() returning a future instead of blocking in execute_typed()
+template<typename T>
+concept StartableTask = requires(T& task) { task.start().get(); };
+
+// ============================================================================
+// HOMOGENEOUS BATCH: one contiguous vector per concrete task type. Execution
+// walks each vector in a loop typed on that task, so calls on final task
+// classes are bound at compile time and tasks are visited in memory order.
+// Startable tasks are all started first and collected last, so their waits
+// overlap instead of holding workers.
+// ============================================================================
+
+template<typename... Tasks>
+class HomogeneousBatch {
+    static_assert(sizeof...(Tasks) > 0, "a batch needs at least one task type");
+    static_assert(sizeof...(Tasks) <= UINT8_MAX, "too many task types");
+
+public:
+    // The reference stays valid until the next task of the same type is added
+    template<typename T, typename... Args>
+    T& emplace(Args&&... args) {
+        auto& group = group_of<T>();
+        group.tasks.emplace_back(std::forward<Args>(args)...);
+        group.positions.push_back(size_++);
+        return group.tasks.back();
+    }
+
+    template<typename T>
+    void reserve(size_t count) {
+        group_of<T>().tasks.reserve(count);
+        group_of<T>().positions.reserve(count);
+    }
+
+    template<typename T>
+    std::span<T> tasks_of() {
+        return group_of<T>().tasks;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    void clear() {
+        (group_of<Tasks>().clear(), ...);
+        size_ = 0;
+    }
+
+    // Results are returned in the order the tasks were added
+    std::vector<AnyResult> execute_sequential() {
+        std::vector<AnyResult> results(size_);
+        auto started = std::make_tuple(start_all<Tasks>()...);
+        (run_range<Tasks>(results, 0, StartableTask<Tasks> ? 0 : group_of<Tasks>().tasks.size()), ...);
+        collect_all(started, results, std::index_sequence_for<Tasks...>{});
+        return results;
+    }
+
+    std::vector<AnyResult> execute_parallel(size_t worker_count = std::thread::hardware_concurrency()) {
+        std::vector<AnyResult> results(size_);
+        worker_count = std::max<size_t>(worker_count, 1);
+        auto started = std::make_tuple(start_all<Tasks>()...);
+
+        std::vector<Chunk> chunks;
+        add_chunks(chunks, worker_count, std::index_sequence_for<Tasks...>{});
+
+        std::atomic<size_t> next_chunk{0};
+        auto work = [&] {
+            for (size_t c = next_chunk++; c < chunks.size(); c = next_chunk++) {
+                run_chunk(chunks[c], results, std::index_sequence_for<Tasks...>{});
+            }
+        };
+
+        std::vector<std::thread> workers;
+        size_t helpers = std::min(worker_count, chunks.size());
+        for (size_t w = 1; w < helpers; ++w) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        collect_all(started, results, std::index_sequence_for<Tasks...>{});
+        return results;
+    }
+
+private:
+    template<typename T>
+    struct Group {
+        std::vector<T> tasks;
+        std::vector<size_t> positions; // insertion index of each task
+
+        void clear() {
+            tasks.clear();
+            positions.clear();
+        }
+    };
+
+    struct Chunk {
+        std::uint8_t group;
+        size_t begin;
+        size_t end;
+    };
+
+    static constexpr size_t kMaxChunk = 256;
+
+    std::tuple<Group<Tasks>...> groups_;
+    size_t size_ = 0;
+
+    template<typename T>
+    Group<T>& group_of() {
+        return std::get<Group<T>>(groups_);
+    }
+
+    template<size_t... I>
+    void add_chunks(std::vector<Chunk>& chunks, size_t worker_count, std::index_sequence<I...>) {
+        auto add = [&](std::uint8_t group, size_t count) {
+            // A few chunks per worker so uneven groups still balance
+            size_t chunk = std::clamp<size_t>(count / (worker_count * 4), 1, kMaxChunk);
+            for (size_t begin = 0; begin < count; begin += chunk) {
+                chunks.push_back({group, begin, std::min(begin + chunk, count)});
+            }
+        };
+        (add(static_cast<std::uint8_t>(I), StartableTask<Tasks> ? 0 : std::get<I>(groups_).tasks.size()), ...);
+    }
+
+    template<size_t... I>
+    void run_chunk(const Chunk& chunk, std::vector<AnyResult>& results, std::index_sequence<I...>) {
+        ((chunk.group == I ? run_range<Tasks>(results, chunk.begin, chunk.end) : void()), ...);
+    }
+
+    template<typename T>
+    void run_range(std::vector<AnyResult>& results, size_t begin, size_t end) {
+        auto& group = group_of<T>();
+        for (size_t k = begin; k < end; ++k) {
+            results[group.positions[k]] = run_one(group.tasks[k]);
+        }
+    }
+
+    // Futures of every task in a startable group; empty for other groups
+    template<typename T>
+    auto start_all() {
+        if constexpr (StartableTask<T>) {
+            std::vector<decltype(std::declval<T&>().start())> futures;
+            futures.reserve(group_of<T>().tasks.size());
+            for (auto& task : group_of<T>().tasks) {
+                futures.push_back(task.start());
+            }
+            return futures;
+        } else {
+            return std::vector<int>{};
+        }
+    }
+
+    template<typename Started, size_t... I>
+    void collect_all(Started& started, std::vector<AnyResult>& results, std::index_sequence<I...>) {
+        (collect<Tasks>(std::get<I>(started), results), ...);
+    }
+
+    template<typename T, typename Futures>
+    void collect(Futures& futures, std::vector<AnyResult>& results) {
+        if constexpr (StartableTask<T>) {
+            auto& group = group_of<T>();
+            for (size_t k = 0; k < futures.size(); ++k) {
+                try {
+                    results[group.positions[k]] = AnyResult{futures[k].get()};
+                } catch (const std::exception& e) {
+                    results[group.positions[k]] = AnyResult{"Error: " + std::string(e.what())};
+                }
+            }
+        }
+    }
+
+    template<typename T>
+    static AnyResult run_one(T& task) {
+        try {
+            return AnyResult{task.execute_typed()};
+        } catch (const std::exception& e) {
+            return AnyResult{"Error: " + std::string(e.what())};
+        }
+    }
+};
+
+}
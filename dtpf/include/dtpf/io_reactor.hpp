@@ -0,0 +1,1030 @@
+// Non-blocking HTTP/1.1 GET requests driven by epoll event loops
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define DTPF_HAS_EPOLL 1
+#endif
+
+namespace dtpf {
+
+// ============================================================================
+// HTTP MESSAGES
+// ============================================================================
+
+struct HttpUrl {
+    std::string host;
+    std::uint16_t port = 80;
+    std::string target = "/"; // path and query
+};
+
+// Only plain http:// URLs; TLS is not supported
+inline std::optional<HttpUrl> parse_http_url(std::string_view url) {
+    constexpr std::string_view kScheme = "http://";
+    if (!url.starts_with(kScheme)) {
+        return std::nullopt;
+    }
+    url.remove_prefix(kScheme.size());
+    size_t slash = url.find('/');
+    std::string_view authority = url.substr(0, slash);
+
+    HttpUrl parsed;
+    if (slash != std::string_view::npos) {
+        parsed.target = std::string(url.substr(slash));
+    }
+    size_t colon = authority.rfind(':');
+    if (colon != std::string_view::npos) {
+        std::string_view port = authority.substr(colon + 1);
+        auto [end, error] = std::from_chars(port.data(), port.data() + port.size(), parsed.port);
+        if (error != std::errc{} || end != port.data() + port.size() || parsed.port == 0) {
+            return std::nullopt;
+        }
+        authority = authority.substr(0, colon);
+    }
+    if (authority.empty()) {
+        return std::nullopt;
+    }
+    parsed.host = std::string(authority);
+    return parsed;
+}
+
+struct HttpResponse {
+    int status = 0;
+    std::string body;
+    bool keep_alive = false; // the server will take another request on this connection
+};
+
+namespace detail {
+
+inline bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+    });
+}
+
+inline bool icontains(std::string_view haystack, std::string_view needle) {
+    for (size_t i = 0; i + needle.size() <= haystack.size(); ++i) {
+        if (iequals(haystack.substr(i, needle.size()), needle)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline std::string_view trim_spaces(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+}
+
+// Incremental response parser: feed it everything received so far, with eof
+// set once the peer has closed. Handles Content-Length, chunked and
+// close-delimited bodies.
+class HttpResponseParser {
+public:
+    enum class State { Incomplete, Complete, Invalid };
+
+    static constexpr size_t kMaxHeaderBytes = 64 * 1024;
+
+    State parse(std::string_view received, bool eof) {
+        if (header_end_ == 0) {
+            size_t end = received.find("\r\n\r\n");
+            if (end == std::string_view::npos) {
+                return eof || received.size() > kMaxHeaderBytes ? State::Invalid : State::Incomplete;
+            }
+            header_end_ = end + 4;
+            if (!parse_head(received.substr(0, end))) {
+                return State::Invalid;
+            }
+        }
+        std::string_view body = received.substr(header_end_);
+        if (no_body_) {
+            return State::Complete;
+        }
+        if (chunked_) {
+            return parse_chunks(body, eof);
+        }
+        if (content_length_) {
+            if (body.size() >= *content_length_) {
+                response_.body = std::string(body.substr(0, *content_length_));
+                return State::Complete;
+            }
+            return eof ? State::Invalid : State::Incomplete;
+        }
+        if (eof) {
+            response_.body = std::string(body);
+            response_.keep_alive = false;
+            return State::Complete;
+        }
+        return State::Incomplete;
+    }
+
+    // Valid once parse() has returned Complete
+    HttpResponse take() { return std::move(response_); }
+
+    // Bytes of received that belong to the completed response
+    size_t consumed() const { return consumed_; }
+
+private:
+    HttpResponse response_;
+    size_t header_end_ = 0;
+    std::optional<size_t> content_length_;
+    bool chunked_ = false;
+    bool no_body_ = false;
+    size_t chunk_offset_ = 0; // next unparsed byte of a chunked body
+    size_t consumed_ = 0;
+
+    bool parse_head(std::string_view head) {
+        size_t line_end = head.find("\r\n");
+        std::string_view status_line = head.substr(0, line_end);
+        if (!status_line.starts_with("HTTP/1.") || status_line.size() < 12) {
+            return false;
+        }
+        auto [end, error] = std::from_chars(status_line.data() + 9, status_line.data() + 12, response_.status);
+        if (error != std::errc{} || end != status_line.data() + 12) {
+            return false;
+        }
+        response_.keep_alive = status_line[7] == '1';
+        no_body_ = response_.status == 204 || response_.status == 304 || response_.status / 100 == 1;
+
+        while (line_end != std::string_view::npos) {
+            head.remove_prefix(line_end + 2);
+            line_end = head.find("\r\n");
+            std::string_view line = head.substr(0, line_end);
+            size_t colon = line.find(':');
+            if (colon == std::string_view::npos) {
+                continue;
+            }
+            std::string_view name = detail::trim_spaces(line.substr(0, colon));
+            std::string_view value = detail::trim_spaces(line.substr(colon + 1));
+            if (detail::iequals(name, "content-length")) {
+                size_t length = 0;
+                auto [value_end, value_error] = std::from_chars(value.data(), value.data() + value.size(), length);
+                if (value_error != std::errc{} || value_end != value.data() + value.size()) {
+                    return false;
+                }
+                content_length_ = length;
+            } else if (detail::iequals(name, "transfer-encoding")) {
+                chunked_ = detail::icontains(value, "chunked");
+            } else if (detail::iequals(name, "connection")) {
+                if (detail::icontains(value, "close")) {
+                    response_.keep_alive = false;
+                } else if (detail::icontains(value, "keep-alive")) {
+                    response_.keep_alive = true;
+                }
+            }
+        }
+        consumed_ = header_end_ + (no_body_ ? 0 : content_length_.value_or(0));
+        return true;
+    }
+
+    State parse_chunks(std::string_view body, bool eof) {
+        for (;;) {
+            size_t line_end = body.find("\r\n", chunk_offset_);
+            if (line_end == std::string_view::npos) {
+                return eof ? State::Invalid : State::Incomplete;
+            }
+            std::string_view size_text = body.substr(chunk_offset_, line_end - chunk_offset_);
+            size_text = size_text.substr(0, size_text.find(';'));
+            size_t size = 0;
+            auto [end, error] = std::from_chars(size_text.data(), size_text.data() + size_text.size(), size, 16);
+            if (error != std::errc{} || size_text.empty()) {
+                return State::Invalid;
+            }
+            size_t data_begin = line_end + 2;
+            if (size == 0) {
+                // Trailers, if any, end with an empty line
+                size_t trailer_end = body.substr(data_begin).starts_with("\r\n")
+                    ? data_begin + 2
+                    : body.find("\r\n\r\n", data_begin);
+                if (trailer_end == std::string_view::npos) {
+                    return eof ? State::Invalid : State::Incomplete;
+                }
+                if (trailer_end != data_begin + 2) {
+                    trailer_end += 4;
+                }
+                consumed_ = header_end_ + trailer_end;
+                return State::Complete;
+            }
+            if (body.size() < data_begin + size + 2) {
+                return eof ? State::Invalid : State::Incomplete;
+            }
+            response_.body.append(body.substr(data_begin, size));
+            chunk_offset_ = data_begin + size + 2;
+        }
+    }
+};
+
+
+// Per-host policy, applied by the reactor loop that owns the host. Zero
+// means unlimited for max_in_flight and rate.
+struct HostLimits {
+    size_t max_in_flight = 0;   // requests on the wire at once
+    size_t rate = 0;            // requests started per second
+    size_t burst = 0;           // token bucket size; 0 means max(rate, 1)
+    size_t max_idle = 64;       // kept-alive connections parked per host
+    std::chrono::milliseconds idle_timeout{30000};
+    std::chrono::milliseconds address_ttl{60000}; // how long a host's looked-up addresses are reused
+};
+
+// ============================================================================
+// I/O REACTOR: each event loop thread owns an epoll set, its sockets and a
+// heap of request deadlines. A request is a non-blocking connect, write and
+// read on one loop, so waiting for the network occupies no thread. All
+// requests to one host and port go to the same loop, which keeps that host's
+// idle keep-alive connections, its token bucket and its in-flight count, so
+// none of them need a lock. Requests over a host's limits wait in a FIFO.
+// getaddrinfo blocks, so host names are looked up on a separate resolver
+// thread; the owning loop keeps the addresses for HostLimits::address_ttl.
+// ============================================================================
+
+#ifdef DTPF_HAS_EPOLL
+
+class IoReactor {
+public:
+    // Runs on a loop thread and must not block
+    using Callback = std::function<void(std::exception_ptr error, HttpResponse response)>;
+
+    struct Stats {
+        std::uint64_t completed = 0;
+        std::uint64_t failed = 0;    // including timeouts
+        std::uint64_t timed_out = 0;
+        std::uint64_t connections_opened = 0;
+        std::uint64_t connections_reused = 0;
+    };
+
+    explicit IoReactor(size_t loop_count = std::thread::hardware_concurrency()) {
+        loop_count = std::max<size_t>(loop_count, 1);
+        for (size_t i = 0; i < loop_count; ++i) {
+            auto loop = std::make_unique<Loop>();
+            loop->epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+            loop->wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (loop->epoll_fd < 0 || loop->wake_fd < 0) {
+                throw std::runtime_error("Cannot create I/O reactor loop");
+            }
+            epoll_event wake{};
+            wake.events = EPOLLIN;
+            wake.data.u64 = kWakeId;
+            ::epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->wake_fd, &wake);
+            loops_.push_back(std::move(loop));
+        }
+        resolver_ = std::thread([this] { resolve_lookups(); });
+        for (auto& loop : loops_) {
+            loop->thread = std::thread([this, raw = loop.get()] { run(*raw); });
+        }
+    }
+
+    // Outstanding requests fail with "reactor stopped"
+    ~IoReactor() {
+        {
+            std::lock_guard<std::mutex> lock(lookup_mutex_);
+            resolver_stopping_ = true;
+        }
+        lookup_ready_.notify_one();
+        resolver_.join();
+        for (auto& loop : loops_) {
+            {
+                std::lock_guard<std::mutex> lock(loop->mutex);
+                loop->stopping = true;
+            }
+            wake(*loop);
+        }
+        for (auto& loop : loops_) {
+            loop->thread.join();
+            ::close(loop->wake_fd);
+            ::close(loop->epoll_fd);
+        }
+    }
+
+    IoReactor(const IoReactor&) = delete;
+    IoReactor& operator=(const IoReactor&) = delete;
+
+    // Process-wide reactor with one loop per core, started on first use
+    static IoReactor& shared() {
+        static IoReactor reactor;
+        return reactor;
+    }
+
+    // Issues a GET without blocking; done is called exactly once, on a loop
+    // thread, or on this thread when the URL is rejected before any I/O
+    // starts. The timeout includes the host name lookup and time spent queued
+    // behind the host's limits. Limits, when given, replace those of the
+    // request's host from then on.
+    void get(std::string_view url, std::chrono::milliseconds timeout, Callback done,
+             std::optional<HostLimits> limits = std::nullopt) {
+        auto request = std::make_unique<Request>();
+        request->url_text = std::string(url);
+        request->done = std::move(done);
+        request->limits = limits;
+        try {
+            auto parsed = parse_http_url(url);
+            if (!parsed) {
+                throw std::invalid_argument("Unsupported URL (only http:// is handled): " + std::string(url));
+            }
+            request->host_name = parsed->host;
+            request->port = parsed->port;
+            request->host_key = parsed->host + ":" + std::to_string(parsed->port);
+            request->out = "GET " + parsed->target + " HTTP/1.1\r\nHost: " + parsed->host +
+                           (parsed->port == 80 ? "" : ":" + std::to_string(parsed->port)) +
+                           "\r\nUser-Agent: dtpf\r\n\r\n";
+        } catch (...) {
+            failed_.fetch_add(1, std::memory_order_relaxed);
+            request->done(std::current_exception(), {});
+            return;
+        }
+        request->id = next_id_.fetch_add(1, std::memory_order_relaxed);
+        request->deadline = std::chrono::steady_clock::now() + timeout;
+
+        Loop& loop = *loops_[std::hash<std::string>{}(request->host_key) % loops_.size()];
+        {
+            std::lock_guard<std::mutex> lock(loop.mutex);
+            loop.incoming.push_back(std::move(request));
+        }
+        wake(loop);
+    }
+
+    std::future<HttpResponse> get(std::string_view url, std::chrono::milliseconds timeout,
+                                  std::optional<HostLimits> limits = std::nullopt) {
+        auto promise = std::make_shared<std::promise<HttpResponse>>();
+        auto future = promise->get_future();
+        get(url, timeout, [promise](std::exception_ptr error, HttpResponse response) {
+            if (error) {
+                promise->set_exception(error);
+            } else {
+                promise->set_value(std::move(response));
+            }
+        }, limits);
+        return future;
+    }
+
+    Stats stats() const {
+        return Stats{completed_.load(std::memory_order_relaxed), failed_.load(std::memory_order_relaxed),
+                     timed_out_.load(std::memory_order_relaxed), opened_.load(std::memory_order_relaxed),
+                     reused_.load(std::memory_order_relaxed)};
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::uint64_t kWakeId = 0;
+    static constexpr size_t kMaxResponseBytes = 64 * 1024 * 1024;
+    static constexpr int kMaxEvents = 256;
+    static constexpr std::chrono::seconds kIdleSweepInterval{1};
+
+    enum class Phase { Queued, Connecting, Writing, Reading };
+
+    struct Host;
+
+    struct Address {
+        sockaddr_storage storage{};
+        socklen_t length = 0;
+    };
+
+    using Addresses = std::shared_ptr<const std::vector<Address>>;
+
+    struct Request {
+        std::uint64_t id = 0;
+        std::string url_text;
+        std::string host_name;
+        std::uint16_t port = 0;
+        std::string host_key;
+        std::optional<HostLimits> limits;
+        Host* host = nullptr;
+        Addresses addresses;      // the host's when the request started
+        size_t first_address = 0; // where connect starts in addresses
+        size_t attempts = 0;      // addresses tried by the current connect
+        int fd = -1;
+        bool reused = false; // fd came from the idle pool
+        Phase phase = Phase::Queued;
+        std::string out;
+        size_t written = 0;
+        std::string in;
+        HttpResponseParser parser;
+        Clock::time_point deadline;
+        Callback done;
+    };
+
+    struct IdleConnection {
+        int fd;
+        Clock::time_point since;
+    };
+
+    struct Host {
+        std::string key;
+        std::string name;
+        std::uint16_t port = 0;
+        HostLimits limits;
+        Addresses addresses;
+        Clock::time_point resolved_until;
+        size_t preferred = 0; // index of the address that last connected
+        bool resolving = false;
+        std::deque<std::uint64_t> waiting; // may hold ids that have since timed out
+        size_t in_flight = 0;
+        double tokens = 0.0;
+        Clock::time_point refilled; // the epoch, so the first take fills the bucket
+        Clock::time_point next_token; // when throttled
+        bool throttled = false;
+        bool scheduled = false;
+        std::vector<IdleConnection> idle;
+    };
+
+    using Deadline = std::pair<Clock::time_point, std::uint64_t>;
+
+    // Null addresses mean the lookup failed
+    struct Resolution {
+        std::string key;
+        Addresses addresses;
+        std::string error;
+    };
+
+    struct Loop {
+        int epoll_fd = -1;
+        int wake_fd = -1;
+        std::thread thread;
+        std::mutex mutex; // guards incoming, resolutions and stopping
+        std::vector<std::unique_ptr<Request>> incoming;
+        std::vector<Resolution> resolutions;
+        bool stopping = false;
+        // Owned by the loop thread
+        std::unordered_map<std::uint64_t, std::unique_ptr<Request>> live;
+        std::priority_queue<Deadline, std::vector<Deadline>, std::greater<>> deadlines;
+        std::unordered_map<std::string, Host> hosts;
+        std::vector<Host*> scheduled;  // hosts whose queues need another look
+        std::vector<Host*> throttled;  // hosts waiting for a token
+        size_t idle_count = 0;
+        Clock::time_point next_sweep;
+    };
+
+    std::vector<std::unique_ptr<Loop>> loops_;
+    std::atomic<std::uint64_t> next_id_{1};
+    std::atomic<std::uint64_t> completed_{0};
+    std::atomic<std::uint64_t> failed_{0};
+    std::atomic<std::uint64_t> timed_out_{0};
+    std::atomic<std::uint64_t> opened_{0};
+    std::atomic<std::uint64_t> reused_{0};
+
+    struct Lookup {
+        Loop* loop;
+        std::string key;
+        std::string name;
+        std::uint16_t port;
+    };
+
+    std::thread resolver_;
+    std::mutex lookup_mutex_; // guards lookups_ and resolver_stopping_
+    std::condition_variable lookup_ready_;
+    std::deque<Lookup> lookups_;
+    bool resolver_stopping_ = false;
+
+    static void wake(Loop& loop) {
+        std::uint64_t one = 1;
+        [[maybe_unused]] auto written = ::write(loop.wake_fd, &one, sizeof(one));
+    }
+
+    // Lookups run one at a time, each answered to the loop that asked
+    void resolve_lookups() {
+        std::unique_lock<std::mutex> lock(lookup_mutex_);
+        for (;;) {
+            lookup_ready_.wait(lock, [this] { return resolver_stopping_ || !lookups_.empty(); });
+            if (resolver_stopping_) {
+                return;
+            }
+            Lookup lookup = std::move(lookups_.front());
+            lookups_.pop_front();
+            lock.unlock();
+            Resolution resolution = resolve(lookup);
+            {
+                std::lock_guard<std::mutex> loop_lock(lookup.loop->mutex);
+                lookup.loop->resolutions.push_back(std::move(resolution));
+            }
+            wake(*lookup.loop);
+            lock.lock();
+        }
+    }
+
+    // Keeps every address, in getaddrinfo's order, so connect can fall back
+    static Resolution resolve(const Lookup& lookup) {
+        Resolution resolution{lookup.key, nullptr, {}};
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* results = nullptr;
+        int status = ::getaddrinfo(lookup.name.c_str(), std::to_string(lookup.port).c_str(), &hints, &results);
+        if (status != 0 || !results) {
+            resolution.error = ::gai_strerror(status);
+            return resolution;
+        }
+        auto addresses = std::make_shared<std::vector<Address>>();
+        for (addrinfo* result = results; result; result = result->ai_next) {
+            Address address;
+            std::memcpy(&address.storage, result->ai_addr, result->ai_addrlen);
+            address.length = static_cast<socklen_t>(result->ai_addrlen);
+            addresses->push_back(address);
+        }
+        ::freeaddrinfo(results);
+        resolution.addresses = std::move(addresses);
+        return resolution;
+    }
+
+    // True while the host's addresses are fresh. Otherwise a lookup is
+    // requested and the host is scheduled again when its answer arrives.
+    bool resolved(Loop& loop, Host& host, Clock::time_point now) {
+        if (host.addresses && now < host.resolved_until) {
+            return true;
+        }
+        if (!host.resolving) {
+            host.resolving = true;
+            {
+                std::lock_guard<std::mutex> lock(lookup_mutex_);
+                lookups_.push_back({&loop, host.key, host.name, host.port});
+            }
+            lookup_ready_.notify_one();
+        }
+        return false;
+    }
+
+    void on_resolved(Loop& loop, Resolution& resolution) {
+        Host& host = loop.hosts[resolution.key];
+        host.resolving = false;
+        if (resolution.addresses) {
+            host.addresses = std::move(resolution.addresses);
+            host.resolved_until = Clock::now() + host.limits.address_ttl;
+            host.preferred = 0;
+            schedule(loop, host);
+            return;
+        }
+        std::deque<std::uint64_t> waiting;
+        waiting.swap(host.waiting);
+        for (std::uint64_t id : waiting) {
+            if (auto it = loop.live.find(id); it != loop.live.end()) {
+                fail(loop, *it->second, "cannot resolve " + host.name + ": " + resolution.error);
+            }
+        }
+    }
+
+    // Milliseconds until the next deadline, token or idle sweep is due
+    static int wait_ms(const Loop& loop) {
+        if (!loop.scheduled.empty()) {
+            return 0;
+        }
+        std::optional<Clock::time_point> next;
+        auto consider = [&](Clock::time_point at) {
+            if (!next || at < *next) {
+                next = at;
+            }
+        };
+        if (!loop.deadlines.empty()) {
+            consider(loop.deadlines.top().first);
+        }
+        for (const Host* host : loop.throttled) {
+            consider(host->next_token);
+        }
+        if (loop.idle_count > 0) {
+            consider(loop.next_sweep);
+        }
+        if (!next) {
+            return -1;
+        }
+        return static_cast<int>(std::max<std::int64_t>(
+            std::chrono::ceil<std::chrono::milliseconds>(*next - Clock::now()).count(), 0));
+    }
+
+    void run(Loop& loop) {
+        epoll_event events[kMaxEvents];
+        for (;;) {
+            int ready = ::epoll_wait(loop.epoll_fd, events, kMaxEvents, wait_ms(loop));
+            if (ready < 0 && errno != EINTR) {
+                break;
+            }
+
+            bool stopping = false;
+            for (int i = 0; i < ready; ++i) {
+                if (events[i].data.u64 == kWakeId) {
+                    stopping = accept_incoming(loop);
+                } else if (auto it = loop.live.find(events[i].data.u64); it != loop.live.end()) {
+                    on_ready(loop, *it->second);
+                }
+            }
+            if (stopping) {
+                break;
+            }
+            expire(loop);
+            release_throttled(loop);
+            dispatch_scheduled(loop);
+            sweep_idle(loop);
+        }
+
+        std::vector<std::unique_ptr<Request>> leftover;
+        {
+            std::lock_guard<std::mutex> lock(loop.mutex);
+            leftover.swap(loop.incoming);
+        }
+        for (auto& [id, request] : loop.live) {
+            leftover.push_back(std::move(request));
+        }
+        loop.live.clear();
+        for (auto& [key, host] : loop.hosts) {
+            for (const IdleConnection& connection : host.idle) {
+                ::close(connection.fd);
+            }
+        }
+        for (auto& request : leftover) {
+            if (request->fd >= 0) {
+                ::close(request->fd);
+            }
+            failed_.fetch_add(1, std::memory_order_relaxed);
+            request->done(std::make_exception_ptr(std::runtime_error("I/O reactor stopped")), {});
+        }
+    }
+
+    // Returns true when the loop should stop
+    bool accept_incoming(Loop& loop) {
+        std::uint64_t count;
+        [[maybe_unused]] auto drained = ::read(loop.wake_fd, &count, sizeof(count));
+        std::vector<std::unique_ptr<Request>> batch;
+        std::vector<Resolution> resolutions;
+        {
+            std::lock_guard<std::mutex> lock(loop.mutex);
+            if (loop.stopping) {
+                return true;
+            }
+            batch.swap(loop.incoming);
+            resolutions.swap(loop.resolutions);
+        }
+        for (auto& owned : batch) {
+            Host& host = loop.hosts[owned->host_key];
+            if (host.key.empty()) {
+                host.key = owned->host_key;
+                host.name = owned->host_name;
+                host.port = owned->port;
+            }
+            if (owned->limits) {
+                host.limits = *owned->limits; // the bucket keeps its tokens
+            }
+            owned->host = &host;
+            std::uint64_t id = owned->id;
+            loop.deadlines.emplace(owned->deadline, id);
+            loop.live.emplace(id, std::move(owned));
+            host.waiting.push_back(id);
+            schedule(loop, host);
+        }
+        for (auto& resolution : resolutions) {
+            on_resolved(loop, resolution);
+        }
+        return false;
+    }
+
+    static size_t bucket_size(const HostLimits& limits) {
+        return limits.burst ? limits.burst : std::max<size_t>(limits.rate, 1);
+    }
+
+    static void schedule(Loop& loop, Host& host) {
+        if (!host.scheduled) {
+            host.scheduled = true;
+            loop.scheduled.push_back(&host);
+        }
+    }
+
+    // Takes one token from the host's bucket, or records when the next is due
+    static bool take_token(Host& host, Clock::time_point now) {
+        if (host.limits.rate == 0) {
+            return true;
+        }
+        double rate = static_cast<double>(host.limits.rate);
+        std::chrono::duration<double> elapsed = now - host.refilled;
+        host.tokens = std::min(static_cast<double>(bucket_size(host.limits)), host.tokens + elapsed.count() * rate);
+        host.refilled = now;
+        if (host.tokens >= 1.0) {
+            host.tokens -= 1.0;
+            return true;
+        }
+        host.next_token = now + std::chrono::ceil<Clock::duration>(
+            std::chrono::duration<double>((1.0 - host.tokens) / rate));
+        return false;
+    }
+
+    void release_throttled(Loop& loop) {
+        auto now = Clock::now();
+        std::erase_if(loop.throttled, [&](Host* host) {
+            if (host->next_token > now) {
+                return false;
+            }
+            host->throttled = false;
+            schedule(loop, *host);
+            return true;
+        });
+    }
+
+    // Starts queued requests while their hosts' limits allow. A request that
+    // fails synchronously reschedules its host rather than recursing.
+    void dispatch_scheduled(Loop& loop) {
+        std::vector<Host*> hosts;
+        hosts.swap(loop.scheduled);
+        auto now = Clock::now();
+        for (Host* host : hosts) {
+            host->scheduled = false;
+            if (!host->waiting.empty() && !resolved(loop, *host, now)) {
+                continue;
+            }
+            while (!host->waiting.empty() && !host->throttled) {
+                if (host->limits.max_in_flight && host->in_flight >= host->limits.max_in_flight) {
+                    break;
+                }
+                auto it = loop.live.find(host->waiting.front());
+                if (it == loop.live.end()) {
+                    host->waiting.pop_front();
+                    continue;
+                }
+                if (!take_token(*host, now)) {
+                    host->throttled = true;
+                    loop.throttled.push_back(host);
+                    break;
+                }
+                host->waiting.pop_front();
+                ++host->in_flight;
+                start(loop, *it->second);
+            }
+        }
+    }
+
+    void sweep_idle(Loop& loop) {
+        auto now = Clock::now();
+        if (loop.idle_count == 0 || now < loop.next_sweep) {
+            return;
+        }
+        loop.next_sweep = now + kIdleSweepInterval;
+        for (auto& [key, host] : loop.hosts) {
+            std::erase_if(host.idle, [&](const IdleConnection& connection) {
+                if (now - connection.since < host.limits.idle_timeout) {
+                    return false;
+                }
+                ::close(connection.fd);
+                --loop.idle_count;
+                return true;
+            });
+        }
+    }
+
+    // A parked connection is usable if it is quiet: no unread bytes and no
+    // FIN from a server that gave up on it
+    static bool still_open(int fd) {
+        char byte;
+        return ::recv(fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT) < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+
+    void start(Loop& loop, Request& request) {
+        Host& host = *request.host;
+        request.addresses = host.addresses;
+        request.first_address = host.preferred;
+        auto now = Clock::now();
+        while (!host.idle.empty()) {
+            IdleConnection connection = host.idle.back();
+            host.idle.pop_back();
+            --loop.idle_count;
+            if (now - connection.since < host.limits.idle_timeout && still_open(connection.fd)) {
+                request.fd = connection.fd;
+                request.reused = true;
+                reused_.fetch_add(1, std::memory_order_relaxed);
+                request.phase = Phase::Writing;
+                watch(loop, request, EPOLL_CTL_ADD, EPOLLOUT);
+                return;
+            }
+            ::close(connection.fd);
+        }
+        connect(loop, request);
+    }
+
+    // Tries the request's addresses in turn, from the one that last
+    // connected to its host, until a connect is under way or all have failed
+    void connect(Loop& loop, Request& request) {
+        request.phase = Phase::Connecting;
+        const std::vector<Address>& addresses = *request.addresses;
+        std::string error;
+        while (request.attempts < addresses.size()) {
+            const Address& address = addresses[(request.first_address + request.attempts) % addresses.size()];
+            ++request.attempts;
+            request.fd = ::socket(address.storage.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (request.fd < 0) {
+                error = "socket: " + std::string(std::strerror(errno));
+                continue;
+            }
+            opened_.fetch_add(1, std::memory_order_relaxed);
+            int one = 1;
+            ::setsockopt(request.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            if (::connect(request.fd, reinterpret_cast<const sockaddr*>(&address.storage), address.length) == 0) {
+                connected(request);
+            } else if (errno != EINPROGRESS) {
+                error = "connect: " + std::string(std::strerror(errno));
+                ::close(request.fd);
+                request.fd = -1;
+                continue;
+            }
+            watch(loop, request, EPOLL_CTL_ADD, EPOLLOUT);
+            return;
+        }
+        fail(loop, request, error);
+    }
+
+    // Later requests to the host start from the address that worked
+    static void connected(Request& request) {
+        request.phase = Phase::Writing;
+        if (request.addresses == request.host->addresses) {
+            request.host->preferred = (request.first_address + request.attempts - 1) % request.addresses->size();
+        }
+    }
+
+    void watch(Loop& loop, Request& request, int operation, std::uint32_t events) {
+        epoll_event event{};
+        event.events = events;
+        event.data.u64 = request.id;
+        if (::epoll_ctl(loop.epoll_fd, operation, request.fd, &event) != 0) {
+            fail(loop, request, "epoll_ctl: " + std::string(std::strerror(errno)));
+        }
+    }
+
+    // The server may close a parked connection just as it is reused. Nothing
+    // of the response has arrived then, so the request is safe to send again
+    // on a fresh connection, once.
+    bool retry_stale(Loop& loop, Request& request) {
+        if (!request.reused || !request.in.empty()) {
+            return false;
+        }
+        ::close(request.fd);
+        request.fd = -1;
+        request.reused = false;
+        request.attempts = 0;
+        request.written = 0;
+        request.parser = HttpResponseParser{};
+        connect(loop, request);
+        return true;
+    }
+
+    void on_ready(Loop& loop, Request& request) {
+        if (request.phase == Phase::Connecting) {
+            int error = 0;
+            socklen_t length = sizeof(error);
+            ::getsockopt(request.fd, SOL_SOCKET, SO_ERROR, &error, &length);
+            if (error != 0) {
+                ::close(request.fd); // also leaves the epoll set
+                request.fd = -1;
+                if (request.attempts < request.addresses->size()) {
+                    connect(loop, request);
+                } else {
+                    fail(loop, request, "connect: " + std::string(std::strerror(error)));
+                }
+                return;
+            }
+            connected(request);
+        }
+
+        if (request.phase == Phase::Writing) {
+            while (request.written < request.out.size()) {
+                ssize_t sent = ::send(request.fd, request.out.data() + request.written,
+                                      request.out.size() - request.written, MSG_NOSIGNAL);
+                if (sent > 0) {
+                    request.written += static_cast<size_t>(sent);
+                } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    return; // EPOLLOUT fires again when there is room
+                } else if (!retry_stale(loop, request)) {
+                    fail(loop, request, "send: " + std::string(std::strerror(errno)));
+                    return;
+                } else {
+                    return;
+                }
+            }
+            request.phase = Phase::Reading;
+            watch(loop, request, EPOLL_CTL_MOD, EPOLLIN | EPOLLRDHUP);
+            return;
+        }
+
+        bool eof = false;
+        char buffer[16 * 1024];
+        for (;;) {
+            ssize_t received = ::recv(request.fd, buffer, sizeof(buffer), 0);
+            if (received > 0) {
+                request.in.append(buffer, static_cast<size_t>(received));
+                if (request.in.size() > kMaxResponseBytes) {
+                    fail(loop, request, "response too large");
+                    return;
+                }
+            } else if (received == 0) {
+                eof = true;
+                break;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            } else if (!retry_stale(loop, request)) {
+                fail(loop, request, "recv: " + std::string(std::strerror(errno)));
+                return;
+            } else {
+                return;
+            }
+        }
+        switch (request.parser.parse(request.in, eof)) {
+            case HttpResponseParser::State::Complete:
+                complete(loop, request, eof);
+                break;
+            case HttpResponseParser::State::Invalid:
+                if (!(eof && retry_stale(loop, request))) {
+                    fail(loop, request, eof ? "connection closed mid-response" : "malformed response");
+                }
+                break;
+            case HttpResponseParser::State::Incomplete:
+                break;
+        }
+    }
+
+    void expire(Loop& loop) {
+        auto now = Clock::now();
+        while (!loop.deadlines.empty() && loop.deadlines.top().first <= now) {
+            std::uint64_t id = loop.deadlines.top().second;
+            loop.deadlines.pop();
+            if (auto it = loop.live.find(id); it != loop.live.end()) {
+                timed_out_.fetch_add(1, std::memory_order_relaxed);
+                fail(loop, *it->second, "timed out");
+            }
+        }
+    }
+
+    // Removes the request from the loop, frees its slot on the host and
+    // returns ownership of it
+    std::unique_ptr<Request> retire(Loop& loop, Request& request) {
+        auto it = loop.live.find(request.id);
+        std::unique_ptr<Request> owned = std::move(it->second);
+        loop.live.erase(it);
+        if (owned->fd >= 0) {
+            ::close(owned->fd); // also leaves the epoll set
+            owned->fd = -1;
+        }
+        if (owned->phase != Phase::Queued) {
+            --owned->host->in_flight;
+            schedule(loop, *owned->host);
+        }
+        return owned;
+    }
+
+    void complete(Loop& loop, Request& request, bool eof) {
+        HttpResponse response = request.parser.take();
+        Host& host = *request.host;
+        // Parked connections leave the epoll set; they are checked again when reused
+        if (response.keep_alive && !eof && request.parser.consumed() == request.in.size() &&
+            host.idle.size() < host.limits.max_idle &&
+            ::epoll_ctl(loop.epoll_fd, EPOLL_CTL_DEL, request.fd, nullptr) == 0) {
+            host.idle.push_back({request.fd, Clock::now()});
+            ++loop.idle_count;
+            request.fd = -1;
+        }
+        auto owned = retire(loop, request);
+        completed_.fetch_add(1, std::memory_order_relaxed);
+        owned->done(nullptr, std::move(response));
+    }
+
+    void fail(Loop& loop, Request& request, const std::string& reason) {
+        auto owned = retire(loop, request);
+        failed_.fetch_add(1, std::memory_order_relaxed);
+        owned->done(std::make_exception_ptr(std::runtime_error("GET " + owned->url_text + ": " + reason)), {});
+    }
+};
+
+#endif
+
+}
@@ -0,0 +1,153 @@
+// Single-pass, allocation-free parsing of "key=value;key=value" strings
+
+#pragma once
+
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+namespace dtpf {
+
+// ============================================================================
+// FIELD DESCRIPTORS: each parameter struct declares its keys once as a table
+// of KvField entries. A field maps an exact key to a member and converts the
+// value with std::from_chars; string fields are views into the input.
+// ============================================================================
+
+template<typename Target>
+struct KvField {
+    std::string_view key;
+    bool (*assign)(Target& target, std::string_view value); // false on a bad value
+};
+
+inline bool kv_convert(std::string_view value, std::string_view& out) {
+    out = value;
+    return true;
+}
+
+template<typename T>
+    requires std::is_integral_v<T> && (!std::is_same_v<T, bool>)
+bool kv_convert(std::string_view value, T& out) {
+    auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), out);
+    return error == std::errc{} && end == value.data() + value.size();
+}
+
+// Durations are written as a plain count of the field's own unit
+template<typename Rep, typename Period>
+bool kv_convert(std::string_view value, std::chrono::duration<Rep, Period>& out) {
+    Rep count{};
+    if (!kv_convert(value, count)) {
+        return false;
+    }
+    out = std::chrono::duration<Rep, Period>(count);
+    return true;
+}
+
+template<typename Target, typename Member>
+Target kv_target_of(Member Target::*);
+
+template<auto Member>
+constexpr auto kv_field(std::string_view key) {
+    using Target = decltype(kv_target_of(Member));
+    return KvField<Target>{key, [](Target& target, std::string_view value) {
+        return kv_convert(value, target.*Member);
+    }};
+}
+
+// ============================================================================
+// PARSING
+// ============================================================================
+
+struct KvError {
+    enum class Kind {
+        MissingEquals, // a segment without '='
+        EmptyKey,
+        BadValue       // the value does not convert to the field's type
+    };
+
+    Kind kind;
+    size_t position;   // offset of the offending segment or value
+    std::string_view key;
+
+    std::string message() const {
+        switch (kind) {
+            case Kind::MissingEquals:
+                return "Expected key=value at offset " + std::to_string(position);
+            case Kind::EmptyKey:
+                return "Empty key at offset " + std::to_string(position);
+            case Kind::BadValue:
+                return "Invalid value for '" + std::string(key) + "' at offset " + std::to_string(position);
+        }
+        return "Invalid configuration";
+    }
+};
+
+// Walks the input once, assigning every known key into out. Keys match
+// exactly; unknown keys and empty segments are skipped and the last
+// occurrence of a repeated key wins.
+template<typename Target>
+std::optional<KvError> parse_kv(std::string_view input, std::span<const KvField<std::type_identity_t<Target>>> fields,
+                                Target& out) {
+    size_t position = 0;
+    while (position < input.size()) {
+        size_t end = input.find(';', position);
+        if (end == std::string_view::npos) {
+            end = input.size();
+        }
+        std::string_view segment = input.substr(position, end - position);
+        if (!segment.empty()) {
+            size_t equals = segment.find('=');
+            if (equals == std::string_view::npos) {
+                return KvError{KvError::Kind::MissingEquals, position, {}};
+            }
+            if (equals == 0) {
+                return KvError{KvError::Kind::EmptyKey, position, {}};
+            }
+            std::string_view key = segment.substr(0, equals);
+            std::string_view value = segment.substr(equals + 1);
+            for (const auto& field : fields) {
+                if (field.key == key) {
+                    if (!field.assign(out, value)) {
+                        return KvError{KvError::Kind::BadValue, position + equals + 1, field.key};
+                    }
+                    break;
+                }
+            }
+        }
+        position = end + 1;
+    }
+    return std::nullopt;
+}
+
+// Throwing form for constructors and factories
+template<typename Target>
+void parse_kv_or_throw(std::string_view input, std::span<const KvField<std::type_identity_t<Target>>> fields,
+                       Target& out) {
+    if (auto error = parse_kv(input, fields, out)) {
+        throw std::invalid_argument(error->message());
+    }
+}
+
+// Appends one "key=value" segment in the form parse_kv reads back. Returns
+// false, appending nothing, when the value holds the ';' separator.
+inline bool kv_append(std::string& out, std::string_view key, std::string_view value) {
+    if (value.find(';') != std::string_view::npos) {
+        return false;
+    }
+    if (!out.empty()) {
+        out.push_back(';');
+    }
+    out.append(key);
+    out.push_back('=');
+    out.append(value);
+    return true;
+}
+
+}
@@ -0,0 +1,357 @@
+// Minimal HTTP/1.1 server on 127.0.0.1 for exercising network tasks
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dtpf/io_reactor.hpp"
+
+#ifdef DTPF_HAS_EPOLL
+#include <arpa/inet.h>
+#endif
+
+namespace dtpf {
+
+// ============================================================================
+// LOOPBACK HTTP SERVER: a single epoll thread serving GETs on an ephemeral
+// port. Connections are kept alive unless the client asks otherwise. Routes:
+//   /delay/<ms>     200 after the given delay, without holding a thread
+//   /bytes/<n>      200 with an n-byte body
+//   /chunked/<n>    200 with an n-byte body in chunked encoding
+//   /status/<code>  the given status
+//   anything else   200 "ok <path>"
+// ============================================================================
+
+#ifdef DTPF_HAS_EPOLL
+
+class LoopbackHttpServer {
+public:
+    struct Stats {
+        std::uint64_t connections = 0;      // accepted in total
+        std::uint64_t peak_connections = 0; // open at the same time
+        std::uint64_t requests = 0;
+    };
+
+    LoopbackHttpServer() {
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int one = 1;
+        ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+        socklen_t length = sizeof(address);
+        if (listen_fd_ < 0 || ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listen_fd_, SOMAXCONN) != 0 ||
+            ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+            if (listen_fd_ >= 0) {
+                ::close(listen_fd_);
+            }
+            throw std::runtime_error("Cannot start loopback HTTP server: " + std::string(std::strerror(errno)));
+        }
+        port_ = ntohs(address.sin_port);
+
+        epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        add(wake_fd_, EPOLLIN, kWakeId);
+        add(listen_fd_, EPOLLIN, kListenId);
+        thread_ = std::thread([this] { run(); });
+    }
+
+    ~LoopbackHttpServer() {
+        stopping_ = true;
+        std::uint64_t one = 1;
+        [[maybe_unused]] auto written = ::write(wake_fd_, &one, sizeof(one));
+        thread_.join();
+        for (auto& [id, connection] : connections_) {
+            ::close(connection.fd);
+        }
+        ::close(listen_fd_);
+        ::close(wake_fd_);
+        ::close(epoll_fd_);
+    }
+
+    LoopbackHttpServer(const LoopbackHttpServer&) = delete;
+    LoopbackHttpServer& operator=(const LoopbackHttpServer&) = delete;
+
+    std::uint16_t port() const { return port_; }
+
+    std::string url(std::string_view path = "/") const {
+        return "http://127.0.0.1:" + std::to_string(port_) + std::string(path);
+    }
+
+    Stats stats() const {
+        return Stats{connections_accepted_.load(std::memory_order_relaxed),
+                     peak_connections_.load(std::memory_order_relaxed),
+                     requests_served_.load(std::memory_order_relaxed)};
+    }
+
+private:
+    static constexpr std::uint64_t kWakeId = 0;
+    static constexpr std::uint64_t kListenId = 1;
+    static constexpr size_t kMaxBodyBytes = 64 * 1024 * 1024;
+
+    struct Connection {
+        int fd = -1;
+        std::string in;
+        std::string out;
+        size_t written = 0;
+        bool waiting = false;     // a delayed response is pending
+        std::string delayed;      // that response
+        bool close_after = false; // close once out drains
+        std::uint32_t events = EPOLLIN | EPOLLRDHUP;
+    };
+
+    using Timer = std::pair<std::chrono::steady_clock::time_point, std::uint64_t>;
+
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::uint16_t port_ = 0;
+    std::thread thread_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<std::uint64_t> connections_accepted_{0};
+    std::atomic<std::uint64_t> peak_connections_{0};
+    std::atomic<std::uint64_t> requests_served_{0};
+    std::uint64_t next_id_ = 2;
+    std::unordered_map<std::uint64_t, Connection> connections_;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers_;
+
+    void add(int fd, std::uint32_t events, std::uint64_t id) {
+        epoll_event event{};
+        event.events = events;
+        event.data.u64 = id;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    void run() {
+        epoll_event events[256];
+        while (!stopping_) {
+            int timeout_ms = -1;
+            if (!timers_.empty()) {
+                auto wait = timers_.top().first - std::chrono::steady_clock::now();
+                timeout_ms = static_cast<int>(std::max<std::int64_t>(
+                    std::chrono::ceil<std::chrono::milliseconds>(wait).count(), 0));
+            }
+            int ready = ::epoll_wait(epoll_fd_, events, 256, timeout_ms);
+            for (int i = 0; i < ready; ++i) {
+                std::uint64_t id = events[i].data.u64;
+                if (id == kListenId) {
+                    accept_all();
+                } else if (id != kWakeId) {
+                    service(id);
+                }
+            }
+            auto now = std::chrono::steady_clock::now();
+            while (!timers_.empty() && timers_.top().first <= now) {
+                std::uint64_t id = timers_.top().second;
+                timers_.pop();
+                if (auto it = connections_.find(id); it != connections_.end() && it->second.waiting) {
+                    it->second.waiting = false;
+                    it->second.out += it->second.delayed;
+                    it->second.delayed.clear();
+                    requests_served_.fetch_add(1, std::memory_order_relaxed);
+                    service(id);
+                }
+            }
+        }
+    }
+
+    void accept_all() {
+        for (;;) {
+            int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                return;
+            }
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            std::uint64_t id = next_id_++;
+            connections_[id].fd = fd;
+            add(fd, EPOLLIN | EPOLLRDHUP, id);
+            connections_accepted_.fetch_add(1, std::memory_order_relaxed);
+            peak_connections_.store(std::max<std::uint64_t>(peak_connections_.load(std::memory_order_relaxed),
+                                                            connections_.size()),
+                                    std::memory_order_relaxed);
+        }
+    }
+
+    void close_connection(std::uint64_t id) {
+        auto it = connections_.find(id);
+        ::close(it->second.fd);
+        connections_.erase(it);
+    }
+
+    // Reads what is available, answers complete requests in order and writes
+    // as much as the socket takes
+    void service(std::uint64_t id) {
+        auto it = connections_.find(id);
+        if (it == connections_.end()) {
+            return;
+        }
+        Connection& connection = it->second;
+
+        bool eof = false;
+        char buffer[16 * 1024];
+        for (;;) {
+            ssize_t received = ::recv(connection.fd, buffer, sizeof(buffer), 0);
+            if (received > 0) {
+                connection.in.append(buffer, static_cast<size_t>(received));
+            } else if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                eof = true;
+                break;
+            } else {
+                break;
+            }
+        }
+
+        while (!connection.waiting && !connection.close_after) {
+            size_t end = connection.in.find("\r\n\r\n");
+            if (end == std::string::npos) {
+                break;
+            }
+            std::string_view head(connection.in.data(), end);
+            bool keep_alive = !detail::icontains(head, "connection: close");
+            std::string response = respond(head, keep_alive, id, connection);
+            connection.in.erase(0, end + 4);
+            connection.close_after = !keep_alive;
+            if (!connection.waiting) {
+                connection.out += response;
+                requests_served_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        while (connection.written < connection.out.size()) {
+            ssize_t sent = ::send(connection.fd, connection.out.data() + connection.written,
+                                  connection.out.size() - connection.written, MSG_NOSIGNAL);
+            if (sent <= 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    close_connection(id);
+                    return;
+                }
+                break;
+            }
+            connection.written += static_cast<size_t>(sent);
+        }
+        bool drained = connection.written == connection.out.size();
+        if (drained) {
+            connection.out.clear();
+            connection.written = 0;
+        }
+        if (drained && !connection.waiting && (connection.close_after || eof)) {
+            close_connection(id);
+            return;
+        }
+        // A peer that has hung up stays readable, so stop listening for it
+        // while a delayed response is still due
+        std::uint32_t wanted = (eof ? 0u : static_cast<std::uint32_t>(EPOLLIN | EPOLLRDHUP)) |
+                               (drained ? 0u : static_cast<std::uint32_t>(EPOLLOUT));
+        if (connection.events != wanted) {
+            connection.events = wanted;
+            epoll_event event{};
+            event.events = wanted;
+            event.data.u64 = id;
+            ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, connection.fd, &event);
+        }
+    }
+
+    static size_t number_after(std::string_view path, std::string_view prefix) {
+        size_t value = 0;
+        std::string_view digits = path.substr(prefix.size());
+        std::from_chars(digits.data(), digits.data() + digits.size(), value);
+        return value;
+    }
+
+    std::string respond(std::string_view head, bool keep_alive, std::uint64_t id, Connection& connection) {
+        std::string_view line = head.substr(0, head.find("\r\n"));
+        size_t path_begin = line.find(' ');
+        size_t path_end = line.find(' ', path_begin + 1);
+        std::string_view path = path_begin == std::string_view::npos
+            ? std::string_view("/")
+            : line.substr(path_begin + 1, path_end - path_begin - 1);
+
+        int status = 200;
+        std::string body;
+        bool chunked = false;
+        if (!line.starts_with("GET ")) {
+            status = 405;
+            body = "only GET is supported";
+        } else if (path.starts_with("/delay/")) {
+            body = "delayed " + std::to_string(number_after(path, "/delay/"));
+        } else if (path.starts_with("/bytes/")) {
+            body.assign(std::min(number_after(path, "/bytes/"), kMaxBodyBytes), 'x');
+        } else if (path.starts_with("/chunked/")) {
+            body.assign(std::min(number_after(path, "/chunked/"), kMaxBodyBytes), 'x');
+            chunked = true;
+        } else if (path.starts_with("/status/")) {
+            status = static_cast<int>(number_after(path, "/status/"));
+            body = "status " + std::to_string(status);
+        } else {
+            body = "ok " + std::string(path);
+        }
+
+        std::string response = "HTTP/1.1 " + std::to_string(status) + (status < 400 ? " OK" : " Error") + "\r\n";
+        response += keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+        if (chunked) {
+            response += "Transfer-Encoding: chunked\r\n\r\n";
+            for (size_t offset = 0; offset < body.size(); offset += 4096) {
+                size_t size = std::min<size_t>(4096, body.size() - offset);
+                char hex[17];
+                auto end = std::to_chars(hex, hex + sizeof(hex), size, 16).ptr;
+                response.append(hex, end).append("\r\n").append(body, offset, size).append("\r\n");
+            }
+            response += "0\r\n\r\n";
+        } else {
+            response += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+        }
+
+        if (path.starts_with("/delay/")) {
+            auto delay = std::chrono::milliseconds(number_after(path, "/delay/"));
+            connection.waiting = true;
+            connection.delayed = std::move(response);
+            timers_.emplace(std::chrono::steady_clock::now() + delay, id);
+            return {};
+        }
+        return response;
+    }
+};
+
+#else
+
+// Without epoll there is nothing to serve; requests to its URLs fail like
+// any other unreachable host
+class LoopbackHttpServer {
+public:
+    struct Stats {
+        std::uint64_t connections = 0;
+        std::uint64_t peak_connections = 0;
+        std::uint64_t requests = 0;
+    };
+
+    std::uint16_t port() const { return 0; }
+
+    std::string url(std::string_view path = "/") const {
+        return "http://127.0.0.1:0" + std::string(path);
+    }
+
+    Stats stats() const { return {}; }
+};
+
+#endif
+
+}
@@ -0,0 +1,278 @@
+// Read-only memory-mapped files and ordered, parallel chunk transforms over them
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define DTPF_HAS_MMAP 1
+#endif
+
+namespace dtpf {
+
+// ============================================================================
+// MAPPED FILE: the whole file is mapped read-only and advised for sequential
+// access. Pages are only read in as they are touched, and ranges that are no
+// longer needed can be handed back with release().
+// ============================================================================
+
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#ifdef DTPF_HAS_MMAP
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            throw std::runtime_error("Cannot open input file: " + path);
+        }
+        struct stat info {};
+        if (::fstat(fd_, &info) != 0) {
+            ::close(fd_);
+            throw std::runtime_error("Cannot stat input file: " + path);
+        }
+        size_ = static_cast<size_t>(info.st_size);
+        if (size_ > 0) {
+            void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd_);
+                throw std::runtime_error("Cannot map input file: " + path);
+            }
+            data_ = static_cast<const char*>(mapped);
+            ::madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+        }
+#else
+        throw std::runtime_error("Memory-mapped input requires mmap support: " + path);
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef DTPF_HAS_MMAP
+        if (data_) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view data() const { return {data_, size_}; }
+    size_t size() const { return size_; }
+
+    // Drops the resident pages wholly inside [offset, offset + length)
+    void release(size_t offset, size_t length) {
+#ifdef DTPF_HAS_MMAP
+        static const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        size_t first = (offset + page - 1) / page * page;
+        size_t last = (offset + length) / page * page;
+        if (data_ && first < last) {
+            ::madvise(const_cast<char*>(data_) + first, last - first, MADV_DONTNEED);
+        }
+#endif
+    }
+
+private:
+    int fd_ = -1;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// ============================================================================
+// CHUNKED TRANSFORM: the file is cut into chunks of about chunk_bytes that
+// end on a delimiter, so no record is split. Workers transform chunks in
+// parallel, and the outputs reach the sink strictly in file order. At most
+// max_chunks_in_flight outputs exist at once, which bounds memory no matter
+// how large the file is.
+// ============================================================================
+
+namespace detail {
+
+// A chunk starts just after the first delimiter at or past its nominal
+// offset minus one, so every worker finds its bounds on its own
+inline size_t chunk_start(std::string_view data, size_t index, size_t chunk_bytes, char delimiter) {
+    if (index == 0) {
+        return 0;
+    }
+    size_t nominal = std::min(index * chunk_bytes, data.size());
+    size_t found = data.find(delimiter, nominal - 1);
+    return found == std::string_view::npos ? data.size() : found + 1;
+}
+
+}
+
+struct ChunkedFileOptions {
+    size_t chunk_bytes = 4 * 1024 * 1024;
+    size_t threads = std::thread::hardware_concurrency();
+    size_t max_chunks_in_flight = 0; // 0 means twice the thread count
+    char delimiter = '\n';
+};
+
+// transform(std::string_view chunk, std::string& out) appends the chunk's
+// output; sink(std::string_view output) receives outputs in order. Returns
+// the number of input bytes read.
+template<typename Transform, typename Sink>
+std::uint64_t transform_file_chunks(const std::string& path, Transform&& transform, Sink&& sink,
+                                    const ChunkedFileOptions& options = {}) {
+    MappedFile file(path);
+    const std::string_view data = file.data();
+    const size_t chunk_bytes = std::max<size_t>(options.chunk_bytes, 1);
+    const size_t chunk_count = (data.size() + chunk_bytes - 1) / chunk_bytes;
+    const size_t worker_count = std::clamp<size_t>(options.threads, 1, std::max<size_t>(chunk_count, 1));
+    const size_t window = options.max_chunks_in_flight ? options.max_chunks_in_flight : 2 * worker_count;
+
+    auto chunk_start = [&](size_t index) {
+        return detail::chunk_start(data, index, chunk_bytes, options.delimiter);
+    };
+
+    struct Slot {
+        std::string output;
+        size_t begin = 0;
+        size_t end = 0;
+        bool ready = false;
+    };
+    std::vector<Slot> slots(window);
+    std::mutex mutex;
+    std::condition_variable window_open;
+    size_t emitted = 0;     // chunks handed to the sink so far
+    bool emitting = false;  // one worker at a time drains ready slots
+    bool failed = false;
+    std::exception_ptr error;
+    std::atomic<size_t> next_chunk{0};
+
+    auto work = [&] {
+        try {
+            for (size_t index = next_chunk++; index < chunk_count; index = next_chunk++) {
+                std::unique_lock<std::mutex> lock(mutex);
+                window_open.wait(lock, [&] { return failed || index < emitted + window; });
+                if (failed) {
+                    return;
+                }
+                lock.unlock();
+
+                Slot done;
+                done.begin = chunk_start(index);
+                done.end = chunk_start(index + 1);
+                if (done.begin < done.end) {
+                    transform(data.substr(done.begin, done.end - done.begin), done.output);
+                }
+                done.ready = true;
+
+                lock.lock();
+                slots[index % window] = std::move(done);
+                if (emitting) {
+                    continue; // the current emitter will pick it up
+                }
+                emitting = true;
+                while (!failed && slots[emitted % window].ready) {
+                    Slot& next = slots[emitted % window];
+                    std::string output = std::move(next.output);
+                    size_t begin = next.begin;
+                    size_t end = next.end;
+                    next = Slot{};
+                    lock.unlock();
+                    if (!output.empty()) {
+                        sink(std::string_view(output));
+                    }
+                    file.release(begin, end - begin);
+                    lock.lock();
+                    ++emitted;
+                    window_open.notify_all();
+                }
+                emitting = false;
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!failed) {
+                failed = true;
+                error = std::current_exception();
+            }
+            window_open.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t w = 1; w < worker_count; ++w) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return data.size();
+}
+
+// Folds a file into one value: map(std::string_view chunk) runs on the
+// chunks in parallel, then combine(accumulated, next) joins the partial
+// results in file order, starting from init
+template<typename Partial, typename Map, typename Combine>
+Partial reduce_file_chunks(const std::string& path, Partial init, Map&& map, Combine&& combine,
+                           const ChunkedFileOptions& options = {}) {
+    MappedFile file(path);
+    const std::string_view data = file.data();
+    const size_t chunk_bytes = std::max<size_t>(options.chunk_bytes, 1);
+    const size_t chunk_count = (data.size() + chunk_bytes - 1) / chunk_bytes;
+    const size_t worker_count = std::clamp<size_t>(options.threads, 1, std::max<size_t>(chunk_count, 1));
+
+    std::vector<Partial> partials(chunk_count, init);
+    std::atomic<size_t> next_chunk{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto work = [&] {
+        try {
+            for (size_t index = next_chunk++; index < chunk_count && !failed; index = next_chunk++) {
+                size_t begin = detail::chunk_start(data, index, chunk_bytes, options.delimiter);
+                size_t end = detail::chunk_start(data, index + 1, chunk_bytes, options.delimiter);
+                partials[index] = map(data.substr(begin, end - begin));
+                file.release(begin, end - begin);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!failed.exchange(true)) {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t w = 1; w < worker_count; ++w) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    Partial result = std::move(init);
+    for (auto& partial : partials) {
+        result = combine(std::move(result), std::move(partial));
+    }
+    return result;
+}
+
+}
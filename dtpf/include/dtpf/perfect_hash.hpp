@@ -0,0 +1,140 @@
+// Immutable string-keyed map with a collision-free (perfect) hash
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dtpf {
+
+// ============================================================================
+// PERFECT HASH MAP: built once from a fixed key set using hash-and-displace.
+// Keys are split into buckets by one hash; every bucket then gets the first
+// seed under which a second hash sends all of its keys to free slots. A lookup
+// is two hashes, one array probe and a single key comparison.
+// ============================================================================
+
+template<typename Value>
+class PerfectHashMap {
+public:
+    PerfectHashMap() = default;
+
+    explicit PerfectHashMap(std::vector<std::pair<std::string, Value>> entries)
+        : entries_(std::move(entries)) {
+        std::sort(entries_.begin(), entries_.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+        auto duplicate = std::adjacent_find(entries_.begin(), entries_.end(),
+                                            [](const auto& a, const auto& b) { return a.first == b.first; });
+        if (duplicate != entries_.end()) {
+            throw std::invalid_argument("Duplicate perfect hash key: " + duplicate->first);
+        }
+        if (entries_.empty()) {
+            return;
+        }
+
+        size_t slot_count = std::bit_ceil(entries_.size());
+        while (!build(slot_count)) {
+            slot_count *= 2; // a sparser table always succeeds eventually
+        }
+    }
+
+    const Value* find(std::string_view key) const noexcept {
+        if (entries_.empty()) {
+            return nullptr;
+        }
+        std::uint64_t seed = seeds_[hash(key, 0) & (seeds_.size() - 1)];
+        std::uint32_t index = slots_[hash(key, seed) & (slots_.size() - 1)];
+        if (index == kEmpty || entries_[index].first != key) {
+            return nullptr;
+        }
+        return &entries_[index].second;
+    }
+
+    size_t size() const noexcept { return entries_.size(); }
+    bool empty() const noexcept { return entries_.empty(); }
+
+    // Entries in key order
+    const std::vector<std::pair<std::string, Value>>& entries() const noexcept { return entries_; }
+
+private:
+    static constexpr std::uint32_t kEmpty = std::numeric_limits<std::uint32_t>::max();
+    static constexpr std::uint64_t kMaxSeedAttempts = 1u << 16;
+
+    std::vector<std::pair<std::string, Value>> entries_;
+    std::vector<std::uint64_t> seeds_; // per bucket
+    std::vector<std::uint32_t> slots_; // index into entries_, or kEmpty
+
+    // Seeded FNV-1a with a final avalanche so low bits are usable as an index
+    static std::uint64_t hash(std::string_view key, std::uint64_t seed) noexcept {
+        std::uint64_t h = 0xcbf29ce484222325ull ^ (seed * 0x9e3779b97f4a7c15ull);
+        for (unsigned char c : key) {
+            h = (h ^ c) * 0x100000001b3ull;
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    bool build(size_t slot_count) {
+        size_t bucket_count = std::bit_ceil(std::max<size_t>(entries_.size() / 2, 1));
+        std::vector<std::vector<std::uint32_t>> buckets(bucket_count);
+        for (std::uint32_t i = 0; i < entries_.size(); ++i) {
+            buckets[hash(entries_[i].first, 0) & (bucket_count - 1)].push_back(i);
+        }
+
+        // Place the most crowded buckets first while the table is still empty
+        std::vector<size_t> order(bucket_count);
+        for (size_t b = 0; b < bucket_count; ++b) {
+            order[b] = b;
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [&](size_t a, size_t b) { return buckets[a].size() > buckets[b].size(); });
+
+        seeds_.assign(bucket_count, 0);
+        slots_.assign(slot_count, kEmpty);
+        std::vector<size_t> placed;
+        for (size_t b : order) {
+            if (buckets[b].empty()) {
+                break;
+            }
+            bool fits = false;
+            for (std::uint64_t seed = 1; seed <= kMaxSeedAttempts && !fits; ++seed) {
+                placed.clear();
+                fits = true;
+                for (std::uint32_t i : buckets[b]) {
+                    size_t slot = hash(entries_[i].first, seed) & (slot_count - 1);
+                    if (slots_[slot] != kEmpty) {
+                        fits = false;
+                        break;
+                    }
+                    slots_[slot] = i;
+                    placed.push_back(slot);
+                }
+                if (fits) {
+                    seeds_[b] = seed;
+                } else {
+                    for (size_t slot : placed) {
+                        slots_[slot] = kEmpty;
+                    }
+                }
+            }
+            if (!fits) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+}
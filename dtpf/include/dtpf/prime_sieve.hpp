@@ -0,0 +1,173 @@
+// Segmented, odd-only, bit-packed Sieve of Eratosthenes
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace dtpf {
+
+namespace detail {
+
+// Odd primes up to limit with a plain odd-only sieve
+inline std::vector<std::uint32_t> odd_base_primes(std::uint64_t limit) {
+    std::vector<std::uint32_t> primes;
+    if (limit < 3) {
+        return primes;
+    }
+    std::vector<bool> composite(limit / 2 + 1); // index i stands for 2i + 1
+    for (std::uint64_t i = 1; 2 * i + 1 <= limit; ++i) {
+        if (composite[i]) {
+            continue;
+        }
+        std::uint64_t p = 2 * i + 1;
+        primes.push_back(static_cast<std::uint32_t>(p));
+        for (std::uint64_t j = p * p / 2; j <= limit / 2; j += p) {
+            composite[j] = true;
+        }
+    }
+    return primes;
+}
+
+// Odd multiples of 3, 5, 7, 11 and 13 repeat every 15015 bits, so those primes
+// are stamped from one precomputed pattern instead of being crossed off
+class PresievePattern {
+public:
+    static constexpr std::uint32_t kPrimes[] = {3, 5, 7, 11, 13};
+    static constexpr std::uint64_t kPeriod = 3 * 5 * 7 * 11 * 13;
+
+    PresievePattern() : words_((kPeriod + 128) / 64 + 1) {
+        for (std::uint64_t k = 0; k < kPeriod + 128; ++k) {
+            for (std::uint32_t p : kPrimes) {
+                if (k % p == (p - 1) / 2) { // bit k is 2k + 1, an odd multiple of p
+                    words_[k >> 6] |= std::uint64_t{1} << (k & 63);
+                    break;
+                }
+            }
+        }
+    }
+
+    // The 64 pattern bits starting at global bit index first
+    std::uint64_t word_at(std::uint64_t first) const {
+        std::uint64_t offset = first % kPeriod;
+        std::uint64_t shift = offset & 63;
+        std::uint64_t low = words_[offset >> 6] >> shift;
+        return shift == 0 ? low : low | (words_[(offset >> 6) + 1] << (64 - shift));
+    }
+
+private:
+    std::vector<std::uint64_t> words_;
+};
+
+inline std::uint64_t isqrt(std::uint64_t n) {
+    auto root = static_cast<std::uint64_t>(std::sqrt(static_cast<double>(n)));
+    while (root * root > n) {
+        --root;
+    }
+    while ((root + 1) * (root + 1) <= n) {
+        ++root;
+    }
+    return root;
+}
+
+}
+
+// ============================================================================
+// PRIME COUNTING: only odd numbers are stored, one bit each, in segments sized
+// to stay in the per-core cache. Workers claim segments from a shared cursor,
+// cross off multiples of the base primes and count survivors with popcount.
+// ============================================================================
+
+struct SieveOptions {
+    size_t segment_bytes = 32 * 1024; // about one L1 data cache
+    size_t threads = std::thread::hardware_concurrency();
+};
+
+// Number of primes <= limit
+inline std::uint64_t count_primes(std::uint64_t limit, const SieveOptions& options = {}) {
+    if (limit < 2) {
+        return 0;
+    }
+    if (limit < 3) {
+        return 1;
+    }
+
+    const std::vector<std::uint32_t> base = detail::odd_base_primes(detail::isqrt(limit));
+
+    // Bit k of the whole sieve stands for the odd number 2k + 1; k = 0 (the
+    // number 1) is skipped and 2 is added back at the end
+    const std::uint64_t total_bits = (limit - 1) / 2 + 1;
+    const std::uint64_t segment_bits = std::max<size_t>(options.segment_bytes, 8) * 8;
+    const std::uint64_t segment_count = (total_bits + segment_bits - 1) / segment_bits;
+
+    const detail::PresievePattern presieve;
+    const auto sieved_from = std::find_if(base.begin(), base.end(),
+                                          [](std::uint32_t p) { return p > 13; });
+
+    std::atomic<std::uint64_t> next_segment{0};
+    std::atomic<std::uint64_t> survivors{0};
+
+    auto work = [&] {
+        std::vector<std::uint64_t> words(segment_bits / 64);
+        std::uint64_t local = 0;
+        for (std::uint64_t s = next_segment++; s < segment_count; s = next_segment++) {
+            std::uint64_t first_bit = s * segment_bits;
+            std::uint64_t bits = std::min(segment_bits, total_bits - first_bit);
+            for (std::uint64_t w = 0; w < words.size(); ++w) {
+                words[w] = presieve.word_at(first_bit + 64 * w);
+            }
+            if (s == 0) {
+                // The pattern also covers the presieve primes themselves
+                for (std::uint32_t p : detail::PresievePattern::kPrimes) {
+                    std::uint64_t k = p / 2;
+                    words[k >> 6] &= ~(std::uint64_t{1} << (k & 63));
+                }
+            }
+
+            for (std::uint32_t p : std::span(sieved_from, base.end())) {
+                // First odd multiple of p at or after both p * p and this segment
+                std::uint64_t square_bit = static_cast<std::uint64_t>(p) * p / 2;
+                std::uint64_t start = square_bit;
+                if (start < first_bit) {
+                    start = first_bit + (p - (first_bit - square_bit) % p) % p;
+                }
+                for (std::uint64_t k = start - first_bit; k < bits; k += p) {
+                    words[k >> 6] |= std::uint64_t{1} << (k & 63);
+                }
+            }
+
+            std::uint64_t whole_words = bits / 64;
+            for (std::uint64_t w = 0; w < whole_words; ++w) {
+                local += std::popcount(~words[w]);
+            }
+            if (std::uint64_t tail = bits % 64) {
+                local += std::popcount(~words[whole_words] & ((std::uint64_t{1} << tail) - 1));
+            }
+        }
+        survivors.fetch_add(local, std::memory_order_relaxed);
+    };
+
+    // Small ranges are not worth a thread start per worker
+    size_t worker_count = std::clamp<size_t>(options.threads, 1, std::max<std::uint64_t>(segment_count / 8, 1));
+    std::vector<std::thread> workers;
+    for (size_t w = 1; w < worker_count; ++w) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // The survivor at bit 0 is 1, which is not prime, and stands in for 2,
+    // which has no bit
+    return survivors.load();
+}
+
+}
@@ -0,0 +1,100 @@
+// The result type of the built-in tasks, with text and binary encodings
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "dtpf/binary_codec.hpp"
+
+namespace dtpf {
+
+// ============================================================================
+// RESULT TYPE
+// ============================================================================
+
+struct ProcessingResult {
+    std::string data;
+    std::int64_t processed_count = 0;
+    std::chrono::system_clock::time_point timestamp;
+    
+    ProcessingResult() : timestamp(std::chrono::system_clock::now()) {}
+    ProcessingResult(const std::string& d, std::int64_t count) : data(d), processed_count(count), timestamp(std::chrono::system_clock::now()) {}
+    
+    std::string serialize() const {
+        auto time_t = std::chrono::system_clock::to_time_t(timestamp);
+        return data + ":" + std::to_string(processed_count) + ":" + std::to_string(time_t);
+    }
+    
+    static ProcessingResult deserialize(const std::string& str) {
+        // Split on the last two colons so that data may itself contain ':'
+        size_t second_colon = str.rfind(':');
+        size_t first_colon = second_colon == std::string::npos || second_colon == 0
+            ? std::string::npos
+            : str.rfind(':', second_colon - 1);
+        if (first_colon != std::string::npos && second_colon != std::string::npos) {
+            ProcessingResult result;
+            result.data = str.substr(0, first_colon);
+            result.processed_count = std::stoll(str.substr(first_colon + 1, second_colon - first_colon - 1));
+            auto time_t = std::stoll(str.substr(second_colon + 1));
+            result.timestamp = std::chrono::system_clock::from_time_t(time_t);
+            return result;
+        }
+        return ProcessingResult{str, 0};
+    }
+    
+    // Binary layout: format byte, length-prefixed data, zigzag varint count,
+    // zigzag varint timestamp in whole seconds
+    static constexpr std::uint8_t kBinaryFormat = 1;
+    
+    // Non-owning decoded form; data points into the encoded bytes
+    struct View {
+        std::string_view data;
+        std::int64_t processed_count = 0;
+        std::int64_t timestamp_seconds = 0;
+    };
+    
+    void serialize_binary(BinaryWriter& writer) const {
+        writer.write_u8(kBinaryFormat);
+        writer.write_bytes(data);
+        writer.write_signed(processed_count);
+        writer.write_signed(std::chrono::system_clock::to_time_t(timestamp));
+    }
+    
+    std::string to_binary() const {
+        BinaryWriter writer;
+        serialize_binary(writer);
+        return writer.take();
+    }
+    
+    static std::optional<View> view_binary(std::string_view bytes) {
+        BinaryReader reader(bytes);
+        if (reader.read_u8() != kBinaryFormat) {
+            return std::nullopt;
+        }
+        View view;
+        view.data = reader.read_bytes();
+        view.processed_count = reader.read_signed();
+        view.timestamp_seconds = reader.read_signed();
+        if (!reader.ok() || !reader.at_end()) {
+            return std::nullopt;
+        }
+        return view;
+    }
+    
+    static std::optional<ProcessingResult> deserialize_binary(std::string_view bytes) {
+        auto view = view_binary(bytes);
+        if (!view) {
+            return std::nullopt;
+        }
+        ProcessingResult result{std::string(view->data), view->processed_count};
+        result.timestamp = std::chrono::system_clock::from_time_t(static_cast<std::time_t>(view->timestamp_seconds));
+        return result;
+    }
+};
+
+}
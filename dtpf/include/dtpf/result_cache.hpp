@@ -0,0 +1,494 @@
+// Content-addressed result cache: sharded LRU with an optional mmap-backed log
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define DTPF_HAS_MMAP 1
+#endif
+
+namespace dtpf {
+
+struct ResultCacheOptions {
+    size_t max_bytes = 64 * 1024 * 1024;        // keys + values + per-entry overhead
+    size_t shard_count = 16;
+    std::string persist_path;                   // empty keeps the cache in memory only
+    size_t max_file_bytes = 256 * 1024 * 1024;  // the log is compacted when it would grow past this
+};
+
+// ============================================================================
+// RESULT LOG FILE: append-only record log in a memory-mapped file. Records
+// carry a checksum, so a torn write at the tail ends replay instead of
+// producing a bad entry; the next append overwrites it. An erased key is
+// logged as a tombstone record without a value.
+// ============================================================================
+
+#ifdef DTPF_HAS_MMAP
+
+class ResultLogFile {
+public:
+    ResultLogFile(const std::string& path, size_t max_bytes) : path_(path), max_bytes_(max_bytes) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ < 0) {
+            throw std::runtime_error("Cannot open result cache file: " + path);
+        }
+        struct stat info {};
+        ::fstat(fd_, &info);
+        remap(std::max<size_t>(static_cast<size_t>(info.st_size), kInitialBytes));
+
+        if (std::memcmp(data_, kMagic, sizeof(kMagic)) != 0) {
+            reset();
+        } else {
+            tail_ = sizeof(kMagic);
+            while (auto record = read_record(tail_)) {
+                tail_ = record->next;
+            }
+        }
+    }
+
+    ~ResultLogFile() {
+        if (data_) {
+            ::msync(data_, tail_, MS_SYNC);
+            ::munmap(data_, capacity_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    ResultLogFile(const ResultLogFile&) = delete;
+    ResultLogFile& operator=(const ResultLogFile&) = delete;
+
+    // Calls visit(key, value) for every intact record, oldest first; value
+    // is nullopt for an erased key
+    template<typename Visit>
+    void replay(Visit&& visit) const {
+        size_t position = sizeof(kMagic);
+        while (auto record = read_record(position)) {
+            if (record->erased) {
+                visit(record->key, std::optional<std::string_view>{});
+            } else {
+                visit(record->key, std::optional<std::string_view>{record->value});
+            }
+            position = record->next;
+        }
+    }
+
+    // Returns false when the record would push the file past max_bytes
+    bool append(std::string_view key, std::string_view value) {
+        return append_record(key, static_cast<std::uint32_t>(value.size()), value);
+    }
+
+    bool append_erase(std::string_view key) {
+        return append_record(key, kErased, {});
+    }
+
+    // Replaces the log with the records fill(append) writes, where
+    // append(key, value) returns false once the log would pass max_bytes.
+    // The new log is written beside the old one and renamed over it, so a
+    // crash part-way leaves the old log intact. Returns false, keeping the
+    // old log, when the new one cannot be written.
+    template<typename Fill>
+    bool rewrite(Fill&& fill) {
+        std::string image(kMagic, sizeof(kMagic));
+        fill([&](std::string_view key, std::string_view value) {
+            size_t needed = kRecordHeader + key.size() + value.size();
+            if (image.size() + needed > max_bytes_) {
+                return false;
+            }
+            size_t at = image.size();
+            image.resize(at + needed);
+            encode_record(image.data() + at, key, static_cast<std::uint32_t>(value.size()), value);
+            return true;
+        });
+
+        std::string temporary = path_ + ".tmp";
+        if (!write_file(temporary, image) || ::rename(temporary.c_str(), path_.c_str()) != 0) {
+            ::unlink(temporary.c_str());
+            return false;
+        }
+        sync_directory();
+
+        int fd = ::open(path_.c_str(), O_RDWR);
+        if (fd < 0) {
+            return false;
+        }
+        ::munmap(data_, capacity_);
+        data_ = nullptr;
+        ::close(fd_);
+        fd_ = fd;
+        size_t capacity = kInitialBytes;
+        while (capacity < image.size()) {
+            capacity *= 2;
+        }
+        remap(std::min(capacity, std::max(max_bytes_, image.size())));
+        tail_ = image.size();
+        return true;
+    }
+
+    // Drops every record
+    void reset() {
+        std::memset(data_, 0, capacity_);
+        std::memcpy(data_, kMagic, sizeof(kMagic));
+        tail_ = sizeof(kMagic);
+    }
+
+    void flush() {
+        ::msync(data_, tail_, MS_SYNC);
+    }
+
+    size_t size() const { return tail_; }
+
+private:
+    static constexpr char kMagic[8] = {'D', 'T', 'P', 'F', 'R', 'C', '0', '2'};
+    static constexpr size_t kRecordHeader = 16; // key size, value size, checksum
+    static constexpr size_t kInitialBytes = 1024 * 1024;
+    static constexpr std::uint32_t kErased = 0xFFFFFFFF; // value size of a tombstone
+
+    struct Record {
+        std::string_view key;
+        std::string_view value;
+        size_t next;
+        bool erased;
+    };
+
+    std::string path_;
+    int fd_ = -1;
+    char* data_ = nullptr;
+    size_t capacity_ = 0;
+    size_t tail_ = 0;
+    size_t max_bytes_;
+
+    static std::uint64_t checksum(std::string_view key, std::uint32_t value_size, std::string_view value) {
+        std::uint64_t h = 0xcbf29ce484222325ull ^ (key.size() * 0x9e3779b97f4a7c15ull) ^ value_size;
+        for (std::string_view part : {key, value}) {
+            for (unsigned char c : part) {
+                h = (h ^ c) * 0x100000001b3ull;
+            }
+        }
+        return h | 1; // never zero, so zero-filled space is never a valid record
+    }
+
+    static void encode_record(char* out, std::string_view key, std::uint32_t value_size, std::string_view value) {
+        auto key_size = static_cast<std::uint32_t>(key.size());
+        std::uint64_t sum = checksum(key, value_size, value);
+        std::memcpy(out, &key_size, 4);
+        std::memcpy(out + 4, &value_size, 4);
+        std::memcpy(out + 8, &sum, 8);
+        std::memcpy(out + kRecordHeader, key.data(), key.size());
+        if (!value.empty()) {
+            std::memcpy(out + kRecordHeader + key.size(), value.data(), value.size());
+        }
+    }
+
+    bool append_record(std::string_view key, std::uint32_t value_size, std::string_view value) {
+        size_t needed = kRecordHeader + key.size() + value.size();
+        if (tail_ + needed > capacity_) {
+            size_t grown = capacity_;
+            while (tail_ + needed > grown) {
+                grown *= 2;
+            }
+            if (grown > max_bytes_) {
+                return false;
+            }
+            remap(grown);
+        }
+        encode_record(data_ + tail_, key, value_size, value);
+        tail_ += needed;
+        return true;
+    }
+
+    std::optional<Record> read_record(size_t position) const {
+        if (capacity_ - position < kRecordHeader) {
+            return std::nullopt;
+        }
+        std::uint32_t key_size = 0;
+        std::uint32_t value_size = 0;
+        std::uint64_t sum = 0;
+        std::memcpy(&key_size, data_ + position, 4);
+        std::memcpy(&value_size, data_ + position + 4, 4);
+        std::memcpy(&sum, data_ + position + 8, 8);
+        bool erased = value_size == kErased;
+        size_t body = static_cast<size_t>(key_size) + (erased ? 0 : value_size);
+        if (key_size == 0 || body > capacity_ - position - kRecordHeader) {
+            return std::nullopt;
+        }
+        std::string_view key(data_ + position + kRecordHeader, key_size);
+        std::string_view value(key.data() + key_size, body - key_size);
+        if (checksum(key, value_size, value) != sum) {
+            return std::nullopt;
+        }
+        return Record{key, value, position + kRecordHeader + body, erased};
+    }
+
+    static bool write_file(const std::string& path, std::string_view image) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        bool written = true;
+        for (size_t offset = 0; written && offset < image.size();) {
+            ssize_t n = ::write(fd, image.data() + offset, image.size() - offset);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            written = n > 0;
+            offset += written ? static_cast<size_t>(n) : 0;
+        }
+        written = written && ::fsync(fd) == 0;
+        ::close(fd);
+        return written;
+    }
+
+    // Makes a rename in the log's directory durable
+    void sync_directory() const {
+        std::filesystem::path directory = std::filesystem::path(path_).parent_path();
+        int fd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            ::fsync(fd);
+            ::close(fd);
+        }
+    }
+
+    void remap(size_t capacity) {
+        if (data_) {
+            ::munmap(data_, capacity_);
+            data_ = nullptr;
+        }
+        if (::ftruncate(fd_, static_cast<off_t>(capacity)) != 0) {
+            throw std::runtime_error("Cannot grow result cache file");
+        }
+        void* mapped = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (mapped == MAP_FAILED) {
+            throw std::runtime_error("Cannot map result cache file");
+        }
+        data_ = static_cast<char*>(mapped);
+        capacity_ = capacity;
+    }
+};
+
+#endif
+
+// ============================================================================
+// RESULT CACHE: keys hash to one of several independently locked shards, each
+// an LRU list bounded by its share of max_bytes. Values are opaque encoded
+// results.
+// ============================================================================
+
+class ResultCache {
+public:
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t insertions = 0;
+        std::uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+
+        double hit_rate() const {
+            std::uint64_t lookups = hits + misses;
+            return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+        }
+    };
+
+    explicit ResultCache(const ResultCacheOptions& options = {})
+        : shards_(std::max<size_t>(options.shard_count, 1)) {
+        shard_budget_ = options.max_bytes / shards_.size();
+        if (!options.persist_path.empty()) {
+#ifdef DTPF_HAS_MMAP
+            log_ = std::make_unique<ResultLogFile>(options.persist_path, options.max_file_bytes);
+            log_->replay([this](std::string_view key, std::optional<std::string_view> value) {
+                // Later records replace or erase earlier ones
+                if (value) {
+                    insert(key, *value);
+                } else {
+                    forget(key);
+                }
+            });
+#else
+            throw std::runtime_error("Persistent result cache requires mmap support");
+#endif
+        }
+    }
+
+    std::optional<std::string> get(std::string_view key) {
+        Shard& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return it->second->value;
+    }
+
+    void put(std::string_view key, std::string_view value) {
+        if (!insert(key, value)) {
+            return;
+        }
+#ifdef DTPF_HAS_MMAP
+        if (log_) {
+            std::lock_guard<std::mutex> lock(log_mutex_);
+            if (!log_->append(key, value)) {
+                compact_log();
+            }
+        }
+#endif
+    }
+
+    // A key that no longer matches its cached value, e.g. one that failed
+    // to decode. The erase is logged, so replay does not bring it back.
+    void erase(std::string_view key) {
+#ifdef DTPF_HAS_MMAP
+        if (log_) {
+            std::lock_guard<std::mutex> lock(log_mutex_);
+            forget(key);
+            if (!log_->append_erase(key)) {
+                compact_log();
+            }
+            return;
+        }
+#endif
+        forget(key);
+    }
+
+    // Forces logged records to disk
+    void flush() {
+#ifdef DTPF_HAS_MMAP
+        if (log_) {
+            std::lock_guard<std::mutex> lock(log_mutex_);
+            log_->flush();
+        }
+#endif
+    }
+
+    Stats stats() const {
+        Stats stats;
+        stats.hits = hits_.load(std::memory_order_relaxed);
+        stats.misses = misses_.load(std::memory_order_relaxed);
+        stats.insertions = insertions_.load(std::memory_order_relaxed);
+        stats.evictions = evictions_.load(std::memory_order_relaxed);
+        for (const auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            stats.entries += shard.entries.size();
+            stats.bytes += shard.bytes;
+        }
+        return stats;
+    }
+
+private:
+    static constexpr size_t kEntryOverhead = 64; // list node, index slot, string headers
+
+    struct Entry {
+        std::string key;
+        std::string value;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> entries; // most recently used first
+        std::unordered_map<std::string_view, std::list<Entry>::iterator> index; // keys view entries
+        size_t bytes = 0;
+    };
+
+    std::vector<Shard> shards_;
+    size_t shard_budget_;
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+    std::atomic<std::uint64_t> insertions_{0};
+    std::atomic<std::uint64_t> evictions_{0};
+#ifdef DTPF_HAS_MMAP
+    std::mutex log_mutex_; // taken before any shard mutex
+    std::unique_ptr<ResultLogFile> log_;
+#endif
+
+    static size_t charge(std::string_view key, std::string_view value) {
+        return key.size() + value.size() + kEntryOverhead;
+    }
+
+    Shard& shard_for(std::string_view key) {
+        return shards_[std::hash<std::string_view>{}(key) % shards_.size()];
+    }
+
+    void remove(Shard& shard, std::list<Entry>::iterator entry) {
+        shard.bytes -= charge(entry->key, entry->value);
+        shard.index.erase(entry->key);
+        shard.entries.erase(entry);
+    }
+
+    void forget(std::string_view key) {
+        Shard& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            remove(shard, it->second);
+        }
+    }
+
+    // Returns false when the entry is too large to cache
+    bool insert(std::string_view key, std::string_view value) {
+        size_t cost = charge(key, value);
+        if (cost > shard_budget_) {
+            return false;
+        }
+        Shard& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (auto it = shard.index.find(key); it != shard.index.end()) {
+            remove(shard, it->second);
+        }
+        while (shard.bytes + cost > shard_budget_) {
+            remove(shard, std::prev(shard.entries.end()));
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
+        shard.entries.push_front(Entry{std::string(key), std::string(value)});
+        shard.index.emplace(shard.entries.front().key, shard.entries.begin());
+        shard.bytes += cost;
+        insertions_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+#ifdef DTPF_HAS_MMAP
+    // Rewrites the log from the live entries, least recently used first so
+    // that replay restores the same recency order. If the new log cannot be
+    // written the old one stays, and later appends keep failing over to here.
+    void compact_log() {
+        log_->rewrite([this](auto&& append) {
+            for (auto& shard : shards_) {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                for (auto it = shard.entries.rbegin(); it != shard.entries.rend(); ++it) {
+                    if (!append(it->key, it->value)) {
+                        return;
+                    }
+                }
+            }
+        });
+    }
+#endif
+};
+
+}
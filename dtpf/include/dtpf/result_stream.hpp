@@ -0,0 +1,225 @@
+// Streaming result delivery with bounded buffering
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dtpf {
+
+// ============================================================================
+// BOUNDED QUEUE: blocking producer/consumer hand-off with a fixed capacity
+// ============================================================================
+
+template<typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {}
+
+    // Blocks while the queue is full; returns false once the queue is closed
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this] { return closed_ || queue_.size() < capacity_; });
+        if (closed_) {
+            return false;
+        }
+        queue_.push_back(std::move(item));
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // Never blocks, even past capacity, for producers such as I/O loops that
+    // must not wait on a consumer; the caller bounds how many such items
+    // there can be. Returns false once the queue is closed.
+    bool push_unbounded(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (closed_) {
+            return false;
+        }
+        queue_.push_back(std::move(item));
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // Blocks while the queue is empty; returns nullopt once closed and drained
+    std::optional<T> pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return closed_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            return std::nullopt;
+        }
+        T item = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+        not_full_.notify_one();
+        return item;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.size();
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+private:
+    size_t capacity_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::deque<T> queue_;
+    bool closed_ = false;
+};
+
+// ============================================================================
+// RESULT STREAMING
+// ============================================================================
+
+// Receives each result together with the index of the task that produced it
+using ResultCallback = std::function<void(size_t index, std::string result)>;
+
+struct StreamOptions {
+    size_t max_in_flight = std::thread::hardware_concurrency(); // tasks executing at once
+    size_t buffer_capacity = 64;                                // finished results awaiting delivery
+};
+
+// Hands the result of one started index to its stream, from any thread
+template<typename Result>
+class StreamDelivery {
+public:
+    using Queue = BoundedQueue<std::pair<size_t, Result>>;
+
+    StreamDelivery(std::shared_ptr<Queue> queue, size_t index) : queue_(std::move(queue)), index_(index) {}
+
+    // A stream that already ended drops the result
+    void operator()(Result result) const {
+        queue_->push_unbounded({index_, std::move(result)});
+    }
+
+private:
+    std::shared_ptr<Queue> queue_;
+    size_t index_;
+};
+
+// As stream_results below, for indices whose work may complete elsewhere,
+// e.g. on an I/O reactor. Each index is first offered to start(i, deliver)
+// on the calling thread. An index it accepts by returning true does not
+// occupy a worker; a copy of deliver must be called exactly once with its
+// result. Those results join the same completion order and do not count
+// against buffer_capacity.
+template<typename Run, typename Start, typename OnResult>
+void stream_results_with_start(size_t count, Run&& run, Start&& start, OnResult&& on_result,
+                               const StreamOptions& options = {}) {
+    if (count == 0) {
+        return;
+    }
+
+    using Result = std::invoke_result_t<Run&, size_t>;
+    // Shared with started work, which may deliver after this returns
+    auto completed = std::make_shared<typename StreamDelivery<Result>::Queue>(options.buffer_capacity);
+
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto fail = [&] {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) {
+            error = std::current_exception();
+        }
+    };
+
+    std::vector<size_t> remaining;
+    try {
+        for (size_t i = 0; i < count; ++i) {
+            if (!start(i, StreamDelivery<Result>(completed, i))) {
+                remaining.push_back(i);
+            }
+        }
+    } catch (...) {
+        completed->close();
+        throw;
+    }
+
+    std::atomic<size_t> next_index{0};
+    size_t worker_count = remaining.empty() ? 0 : std::clamp<size_t>(options.max_in_flight, 1, remaining.size());
+    std::vector<std::thread> workers;
+    workers.reserve(worker_count);
+    for (size_t w = 0; w < worker_count; ++w) {
+        workers.emplace_back([&] {
+            try {
+                for (size_t k = next_index++; k < remaining.size(); k = next_index++) {
+                    if (!completed->push({remaining[k], run(remaining[k])})) {
+                        return; // consumer gave up
+                    }
+                }
+            } catch (...) {
+                fail();
+                completed->close(); // the consumer drains what was queued
+            }
+        });
+    }
+
+    for (size_t delivered = 0; delivered < count; ++delivered) {
+        auto item = completed->pop();
+        if (!item) {
+            break;
+        }
+        try {
+            on_result(item->first, std::move(item->second));
+        } catch (...) {
+            fail();
+            break;
+        }
+    }
+
+    completed->close();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+// Runs run(i) for every index on worker threads and hands each result to
+// on_result on the calling thread in completion order. Workers block once
+// buffer_capacity results are waiting, so a slow consumer throttles execution
+// and at most max_in_flight + buffer_capacity results are alive at a time.
+// The first exception from run or on_result ends the stream and is rethrown
+// once the workers are joined; results queued before a run failed are still
+// delivered.
+template<typename Run, typename OnResult>
+void stream_results(size_t count, Run&& run, OnResult&& on_result,
+                    const StreamOptions& options = {}) {
+    using Result = std::invoke_result_t<Run&, size_t>;
+    stream_results_with_start(count, run, [](size_t, const StreamDelivery<Result>&) { return false; },
+                              on_result, options);
+}
+
+}
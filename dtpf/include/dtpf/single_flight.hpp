@@ -0,0 +1,73 @@
+// Coalesces concurrent executions of identical work into one
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace dtpf {
+
+// ============================================================================
+// SINGLE FLIGHT: the first caller for a key runs the work; callers that
+// arrive with the same key while it is still running wait for that result
+// instead of starting their own. Nothing is kept once the call finishes.
+// ============================================================================
+
+template<typename Value>
+class SingleFlight {
+public:
+    struct Stats {
+        std::uint64_t executions = 0; // calls that ran the work
+        std::uint64_t coalesced = 0;  // calls that shared another caller's result
+    };
+
+    template<typename Fn>
+    Value run(const std::string& key, Fn&& fn) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (auto it = in_flight_.find(key); it != in_flight_.end()) {
+            std::shared_future<Value> pending = it->second;
+            lock.unlock();
+            coalesced_.fetch_add(1, std::memory_order_relaxed);
+            return pending.get(); // rethrows the leader's exception
+        }
+        std::promise<Value> promise;
+        in_flight_.emplace(key, promise.get_future().share());
+        lock.unlock();
+        executions_.fetch_add(1, std::memory_order_relaxed);
+
+        // Followers must see the outcome before the key is released
+        auto finish = [&] {
+            std::lock_guard<std::mutex> guard(mutex_);
+            in_flight_.erase(key);
+        };
+        try {
+            Value value = std::forward<Fn>(fn)();
+            promise.set_value(value);
+            finish();
+            return value;
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+            finish();
+            throw;
+        }
+    }
+
+    Stats stats() const {
+        return Stats{executions_.load(std::memory_order_relaxed), coalesced_.load(std::memory_order_relaxed)};
+    }
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_future<Value>> in_flight_;
+    std::atomic<std::uint64_t> executions_{0};
+    std::atomic<std::uint64_t> coalesced_{0};
+};
+
+}
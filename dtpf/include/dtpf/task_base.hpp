@@ -0,0 +1,113 @@
+// Task interfaces shared by every translation unit that runs tasks
+
+#pragma once
+
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "dtpf/any_result.hpp"
+#include "dtpf/binary_codec.hpp"
+#include "dtpf/task_type_registry.hpp"
+
+namespace dtpf {
+
+// ============================================================================
+// TASK BASE CLASSES
+// ============================================================================
+
+template<typename T>
+concept TaskResult = requires(T t) {
+    { t.serialize() } -> std::convertible_to<std::string>;
+    { T::deserialize(std::string{}) } -> std::same_as<T>;
+    std::movable<T>;
+};
+
+class TaskBase {
+public:
+    virtual ~TaskBase() = default;
+    virtual std::string execute() = 0;
+    virtual std::string get_type() const = 0;
+    // Interned id of get_type(); tasks with a fixed type name return a cached id
+    virtual TaskTypeId get_type_id() const { return TaskTypeRegistry::instance().intern(get_type()); }
+    virtual int get_priority() const = 0;
+    // Latency budget measured from submission; zero means best-effort batch work
+    virtual std::chrono::milliseconds get_deadline() const { return std::chrono::milliseconds::zero(); }
+    // Typed result for in-process consumers; text is produced only on demand
+    virtual AnyResult execute_any() { return AnyResult{execute()}; }
+    // Tasks with equal non-empty content keys are interchangeable while running,
+    // so identical in-flight tasks can share one execution. Cacheable tasks are
+    // pure functions of the key and may also reuse earlier results.
+    virtual std::string content_key() const { return {}; }
+    // Parameters that rebuild this task through its type's from_config;
+    // empty when the task cannot be written out that way
+    virtual std::optional<std::string> to_config() const { return std::nullopt; }
+    // Estimated bytes held while queued or running, charged against
+    // admission memory budgets
+    virtual size_t memory_footprint() const { return 256; }
+    virtual bool is_cacheable() const { return false; }
+    // Cache encoding of a result from this task, and its inverse; an empty
+    // AnyResult means the bytes did not decode
+    virtual std::optional<std::string> encode_result(const AnyResult& result) const { return result.to_string(); }
+    virtual AnyResult decode_result(std::string_view bytes) const { return AnyResult{std::string(bytes)}; }
+    // Tasks whose work completes elsewhere, e.g. on an I/O reactor, start it
+    // here without blocking and return true; done is then called exactly
+    // once, from any thread. False means run execute_any instead.
+    using StartCallback = std::function<void(std::exception_ptr error, AnyResult result)>;
+    virtual bool start_any(StartCallback done) { return false; }
+};
+
+template<TaskResult R>
+class Task : public TaskBase {
+public:
+    virtual R execute_typed() = 0;
+    std::string execute() override {
+        return execute_typed().serialize();
+    }
+    AnyResult execute_any() override {
+        return AnyResult{execute_typed()};
+    }
+    
+    std::chrono::milliseconds get_deadline() const override { return deadline_; }
+    void set_deadline(std::chrono::milliseconds deadline) { deadline_ = deadline; }
+    
+    // Uses the binary form when R has one
+    std::optional<std::string> encode_result(const AnyResult& result) const override {
+        const R* value = result.get_if<R>();
+        if (!value) {
+            return std::nullopt;
+        }
+        if constexpr (requires(const R& r, BinaryWriter& writer) { r.serialize_binary(writer); }) {
+            BinaryWriter writer;
+            value->serialize_binary(writer);
+            return writer.take();
+        } else {
+            return value->serialize();
+        }
+    }
+    
+    AnyResult decode_result(std::string_view bytes) const override {
+        if constexpr (requires { R::deserialize_binary(bytes); }) {
+            if (auto value = R::deserialize_binary(bytes)) {
+                return AnyResult{std::move(*value)};
+            }
+            return AnyResult{};
+        } else {
+            try {
+                return AnyResult{R::deserialize(std::string(bytes))};
+            } catch (const std::exception&) {
+                return AnyResult{};
+            }
+        }
+    }
+    
+private:
+    std::chrono::milliseconds deadline_{0};
+};
+
+}
@@ -0,0 +1,221 @@
+// Columnar storage for large numbers of lightweight tasks
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "dtpf/any_result.hpp"
+#include "dtpf/counting_sort.hpp"
+#include "dtpf/task_config.hpp"
+#include "dtpf/task_type_registry.hpp"
+
+namespace dtpf {
+
+// ============================================================================
+// TASK BATCH: one contiguous array per task attribute instead of one heap
+// object per task. Scans that need only priorities or types read a dense
+// array. Each task's parameters are a slice of one shared arena, in the
+// "key=value;..." form that from_config takes. Sorting permutes the small
+// fixed-size columns and never moves the arena.
+// ============================================================================
+
+class TaskBatch {
+public:
+    using Row = std::uint32_t;
+
+    static constexpr size_t kMaxRows = std::numeric_limits<Row>::max();
+    static constexpr size_t kMaxArenaBytes = std::numeric_limits<std::uint32_t>::max();
+
+    struct RowRange {
+        size_t begin;
+        size_t end;
+    };
+
+    // Returns the task's id, its row at insertion
+    Row add(TaskTypeId type, int priority, std::string_view params,
+            std::chrono::milliseconds deadline = std::chrono::milliseconds::zero()) {
+        begin_row(params.size());
+        arena_.append(params);
+        return end_row(type, priority, deadline);
+    }
+
+    Row add(const TaskConfig& config) {
+        begin_row(0);
+        config.append_parameters(arena_);
+        if (arena_.size() > kMaxArenaBytes) {
+            arena_.resize(param_offsets_.back());
+            param_offsets_.pop_back();
+            throw std::length_error("Task batch parameter arena is full");
+        }
+        return end_row(TaskTypeRegistry::instance().intern(config.type), config.priority,
+                       std::chrono::milliseconds::zero());
+    }
+
+    void reserve(size_t tasks, size_t param_bytes = 0) {
+        type_ids_.reserve(tasks);
+        priorities_.reserve(tasks);
+        deadlines_.reserve(tasks);
+        param_offsets_.reserve(tasks);
+        param_lengths_.reserve(tasks);
+        ids_.reserve(tasks);
+        arena_.reserve(param_bytes);
+    }
+
+    size_t size() const { return ids_.size(); }
+    bool empty() const { return ids_.empty(); }
+
+    void clear() {
+        type_ids_.clear();
+        priorities_.clear();
+        deadlines_.clear();
+        param_offsets_.clear();
+        param_lengths_.clear();
+        ids_.clear();
+        results_.clear();
+        arena_.clear();
+    }
+
+    std::span<const TaskTypeId> type_ids() const { return type_ids_; }
+    std::span<const std::int32_t> priorities() const { return priorities_; }
+    std::span<const std::chrono::milliseconds> deadlines() const { return deadlines_; }
+    std::span<const Row> ids() const { return ids_; }
+
+    std::string_view params(size_t row) const {
+        return std::string_view(arena_).substr(param_offsets_[row], param_lengths_[row]);
+    }
+
+    // One slot per row, empty until a result is stored. The slots are
+    // allocated on first use and move with their rows when sorted.
+    std::span<AnyResult> results() {
+        if (results_.size() != size()) {
+            results_.resize(size());
+        }
+        return results_;
+    }
+
+    std::span<const AnyResult> results() const { return results_; }
+
+    // Row k becomes what was row order[k]
+    void permute(std::span<const Row> order) {
+        if (order.size() != size()) {
+            throw std::invalid_argument("Permutation size does not match the batch");
+        }
+        gather(type_ids_, order);
+        gather(priorities_, order);
+        gather(deadlines_, order);
+        gather(param_offsets_, order);
+        gather(param_lengths_, order);
+        gather(ids_, order);
+        if (!results_.empty()) {
+            gather(results_, order);
+        }
+    }
+
+    // Stable linear-time sorts: rows with equal keys keep their relative order
+
+    void sort_by_priority(bool descending = true) {
+        sort_rows([&](size_t row) {
+            return descending ? descending_key(priorities_[row]) : ascending_key(priorities_[row]);
+        });
+    }
+
+    // type_ranks[id] orders the types; ids without a rank sort after all ranked ones
+    void sort_by_type(std::span<const size_t> type_ranks = {}) {
+        sort_rows([&](size_t row) {
+            TaskTypeId type = type_ids_[row];
+            return static_cast<std::uint32_t>(type < type_ranks.size() ? type_ranks[type] : type_ranks.size() + type);
+        });
+    }
+
+    // Earliest deadline first; best-effort rows, with no deadline, go last
+    void sort_by_deadline() {
+        sort_rows([&](size_t row) {
+            auto deadline = deadlines_[row].count();
+            return deadline <= 0 ? std::numeric_limits<std::uint32_t>::max()
+                                 : static_cast<std::uint32_t>(std::min<std::int64_t>(
+                                       deadline, std::numeric_limits<std::uint32_t>::max() - 1));
+        });
+    }
+
+    // Maximal runs of equal values, meaningful after the matching sort
+    std::vector<RowRange> priority_runs() const { return runs(priorities_); }
+    std::vector<RowRange> type_runs() const { return runs(type_ids_); }
+
+private:
+    std::vector<TaskTypeId> type_ids_;
+    std::vector<std::int32_t> priorities_;
+    std::vector<std::chrono::milliseconds> deadlines_;
+    std::vector<std::uint32_t> param_offsets_;
+    std::vector<std::uint32_t> param_lengths_;
+    std::vector<Row> ids_;
+    std::vector<AnyResult> results_;
+    std::string arena_;
+
+    void begin_row(size_t param_bytes) {
+        if (size() >= kMaxRows) {
+            throw std::length_error("Task batch is full");
+        }
+        if (arena_.size() + param_bytes > kMaxArenaBytes) {
+            throw std::length_error("Task batch parameter arena is full");
+        }
+        param_offsets_.push_back(static_cast<std::uint32_t>(arena_.size()));
+    }
+
+    Row end_row(TaskTypeId type, int priority, std::chrono::milliseconds deadline) {
+        param_lengths_.push_back(static_cast<std::uint32_t>(arena_.size() - param_offsets_.back()));
+        type_ids_.push_back(type);
+        priorities_.push_back(priority);
+        deadlines_.push_back(deadline);
+        auto id = static_cast<Row>(ids_.size());
+        ids_.push_back(id);
+        if (!results_.empty()) {
+            results_.emplace_back();
+        }
+        return id;
+    }
+
+    template<typename T>
+    static void gather(std::vector<T>& column, std::span<const Row> order) {
+        std::vector<T> gathered;
+        gathered.reserve(column.size());
+        for (Row row : order) {
+            gathered.push_back(std::move(column[row]));
+        }
+        column = std::move(gathered);
+    }
+
+    // The keys are read from one column into a flat array and counting-sorted
+    template<typename Key>
+    void sort_rows(Key&& key) {
+        std::vector<std::uint32_t> keys(size());
+        for (size_t row = 0; row < keys.size(); ++row) {
+            keys[row] = key(row);
+        }
+        permute(stable_key_order(keys));
+    }
+
+    template<typename T>
+    static std::vector<RowRange> runs(const std::vector<T>& column) {
+        std::vector<RowRange> ranges;
+        size_t begin = 0;
+        for (size_t row = 1; row <= column.size(); ++row) {
+            if (row == column.size() || column[row] != column[begin]) {
+                ranges.push_back({begin, row});
+                begin = row;
+            }
+        }
+        return ranges;
+    }
+};
+
+}
@@ -0,0 +1,33 @@
+// Parsed description of a task, shared by the config parser and the factories
+
+#pragma once
+
+#include <map>
+#include <string>
+
+namespace dtpf {
+
+struct TaskConfig {
+    std::string type;
+    std::map<std::string, std::string> properties;
+    int priority = 0;
+    std::string node_assignment;
+    
+    bool has_property(const std::string& key) const {
+        return properties.find(key) != properties.end();
+    }
+    
+    std::string get_property(const std::string& key, const std::string& default_value = "") const {
+        auto it = properties.find(key);
+        return (it != properties.end()) ? it->second : default_value;
+    }
+    
+    // Appends the properties in the "key=value;..." form taken by from_config
+    void append_parameters(std::string& out) const {
+        for (const auto& [key, value] : properties) {
+            out.append(key).append("=").append(value).append(";");
+        }
+    }
+};
+
+}
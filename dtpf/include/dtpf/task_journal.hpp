@@ -0,0 +1,421 @@
+// Durable write-ahead journal of task submissions and completions
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "dtpf/binary_codec.hpp"
+#include "dtpf/byte_kernels.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define DTPF_HAS_MMAP 1
+#endif
+
+namespace dtpf {
+
+struct TaskJournalOptions {
+    bool sync = true;                   // false leaves write-back to the OS, so a crash may lose the tail
+    size_t initial_bytes = 1024 * 1024; // the mapping doubles whenever it fills
+};
+
+// A submission with no completion, found when the journal was opened
+struct JournaledTask {
+    std::uint64_t id;
+    std::string type;
+    std::string config;
+};
+
+// ============================================================================
+// TASK JOURNAL: append-only log of submissions and completions in a
+// memory-mapped file. An append is a copy into the mapping; commit() makes
+// everything appended so far durable. Concurrent commits are grouped: one
+// caller syncs the file while the others wait, and whatever is appended
+// during that sync rides on the next one, so one fdatasync covers many
+// records. Opening replays the log up to the first torn or corrupt record
+// and atomically rewrites it with only the unfinished submissions.
+// ============================================================================
+
+#ifdef DTPF_HAS_MMAP
+
+class TaskJournal {
+public:
+    struct Stats {
+        std::uint64_t appends = 0;
+        std::uint64_t commits = 0; // commit() calls that had records to wait for
+        std::uint64_t syncs = 0;   // file syncs those commits shared
+        size_t bytes = 0;
+    };
+
+    explicit TaskJournal(const std::string& path, const TaskJournalOptions& options = {})
+        : options_(options) {
+        recovered_ = read_unfinished(path);
+        write_snapshot(path, recovered_);
+
+        fd_ = ::open(path.c_str(), O_RDWR);
+        if (fd_ < 0) {
+            throw std::runtime_error("Cannot open task journal: " + path);
+        }
+        struct stat info {};
+        ::fstat(fd_, &info);
+        tail_ = durable_ = static_cast<size_t>(info.st_size);
+        next_id_ = recovered_.empty() ? 1 : recovered_.back().id + 1;
+
+        size_t capacity = std::max<size_t>(options.initial_bytes, 4096);
+        while (capacity < tail_ * 2) {
+            capacity *= 2;
+        }
+        remap(capacity);
+    }
+
+    ~TaskJournal() {
+        if (data_) {
+            if (options_.sync) {
+                sync_file(tail_);
+            }
+            ::munmap(data_, capacity_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    TaskJournal(const TaskJournal&) = delete;
+    TaskJournal& operator=(const TaskJournal&) = delete;
+
+    // Hands over the unfinished submissions, oldest first. They stay in the
+    // journal until completed or reset.
+    std::vector<JournaledTask> take_recovered() { return std::move(recovered_); }
+
+    // Returns the id that complete() takes
+    std::uint64_t submit(std::string_view type, std::string_view config) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::uint64_t id = next_id_++;
+        BinaryWriter writer;
+        encode_submit(writer, id, type, config);
+        append(writer.view());
+        return id;
+    }
+
+    void complete(std::uint64_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        BinaryWriter writer;
+        writer.write_u8(kComplete);
+        writer.write_varint(id);
+        append(writer.view());
+    }
+
+    // Returns once every record appended before the call is on disk
+    void commit() {
+        if (!options_.sync) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        const size_t target = tail_;
+        if (durable_ >= target) {
+            return;
+        }
+        ++stats_.commits;
+        while (durable_ < target) {
+            if (syncing_) {
+                synced_.wait(lock);
+                continue;
+            }
+            syncing_ = true;
+            size_t end = tail_;
+            lock.unlock();
+            bool synced = sync_file(end);
+            lock.lock();
+            syncing_ = false;
+            if (synced) {
+                durable_ = std::max(durable_, end);
+                ++stats_.syncs;
+            }
+            synced_.notify_all();
+            if (!synced) {
+                throw std::runtime_error("Cannot sync task journal");
+            }
+        }
+    }
+
+    // Drops every record. The first record is cleared and synced before the
+    // rest, so a crash part way through never revives an older prefix.
+    void reset() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        synced_.wait(lock, [this] { return !syncing_; });
+        std::memset(data_ + sizeof(kMagic), 0, std::min(tail_, sizeof(kMagic) + kRecordHeader) - sizeof(kMagic));
+        bool synced = sync_file(tail_);
+        std::memset(data_ + sizeof(kMagic), 0, tail_ - sizeof(kMagic));
+        synced = sync_file(tail_) && synced;
+        tail_ = durable_ = sizeof(kMagic);
+        if (!synced) {
+            throw std::runtime_error("Cannot sync task journal");
+        }
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats stats = stats_;
+        stats.bytes = tail_;
+        return stats;
+    }
+
+private:
+    static constexpr char kMagic[8] = {'D', 'T', 'P', 'F', 'W', 'A', 'L', '1'};
+    static constexpr size_t kRecordHeader = 8; // body size, CRC-32C of the body
+    static constexpr std::uint8_t kSubmit = 1;
+    static constexpr std::uint8_t kComplete = 2;
+
+    struct Record {
+        std::string_view body;
+        size_t next;
+    };
+
+    TaskJournalOptions options_;
+    int fd_ = -1;
+    char* data_ = nullptr;
+    size_t capacity_ = 0;
+    std::vector<JournaledTask> recovered_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable synced_;
+    size_t tail_ = 0;      // end of the last appended record
+    size_t durable_ = 0;   // end of the last record known to be on disk
+    bool syncing_ = false; // a sync is running without the lock; the mapping must not move
+    std::uint64_t next_id_ = 1;
+    Stats stats_;
+
+    static void encode_submit(BinaryWriter& writer, std::uint64_t id, std::string_view type,
+                              std::string_view config) {
+        writer.write_u8(kSubmit);
+        writer.write_varint(id);
+        writer.write_bytes(type);
+        writer.write_bytes(config);
+    }
+
+    static std::uint32_t checksum(std::string_view body) {
+        return byte_kernels().crc32c(0, body.data(), body.size());
+    }
+
+    static void append_record(std::string& out, std::string_view body) {
+        auto size = static_cast<std::uint32_t>(body.size());
+        std::uint32_t sum = checksum(body);
+        out.append(reinterpret_cast<const char*>(&size), 4);
+        out.append(reinterpret_cast<const char*>(&sum), 4);
+        out.append(body);
+    }
+
+    // Every body holds at least a kind and an id, so zero-filled space never
+    // reads as a record
+    static std::optional<Record> read_record(std::string_view data, size_t position) {
+        if (data.size() - position < kRecordHeader) {
+            return std::nullopt;
+        }
+        std::uint32_t size = 0;
+        std::uint32_t sum = 0;
+        std::memcpy(&size, data.data() + position, 4);
+        std::memcpy(&sum, data.data() + position + 4, 4);
+        if (size < 2 || size > data.size() - position - kRecordHeader) {
+            return std::nullopt;
+        }
+        std::string_view body = data.substr(position + kRecordHeader, size);
+        if (checksum(body) != sum) {
+            return std::nullopt;
+        }
+        return Record{body, position + kRecordHeader + size};
+    }
+
+    // Caller holds mutex_, which a wait for a running sync may release
+    void append(std::string_view body) {
+        if (body.size() > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::length_error("Task journal record is too large");
+        }
+        size_t needed = kRecordHeader + body.size();
+        while (tail_ + needed > capacity_) {
+            if (syncing_) {
+                std::unique_lock<std::mutex> lock(mutex_, std::adopt_lock);
+                synced_.wait(lock);
+                lock.release();
+                continue;
+            }
+            size_t grown = capacity_;
+            while (tail_ + needed > grown) {
+                grown *= 2;
+            }
+            remap(grown);
+        }
+        auto size = static_cast<std::uint32_t>(body.size());
+        std::uint32_t sum = checksum(body);
+        char* out = data_ + tail_;
+        std::memcpy(out, &size, 4);
+        std::memcpy(out + 4, &sum, 4);
+        std::memcpy(out + kRecordHeader, body.data(), body.size());
+        tail_ += needed;
+        ++stats_.appends;
+    }
+
+    // On Linux fdatasync also writes back pages dirtied through the mapping
+    bool sync_file(size_t end) {
+#ifdef __linux__
+        (void)end;
+        return ::fdatasync(fd_) == 0;
+#else
+        return ::msync(data_, end, MS_SYNC) == 0;
+#endif
+    }
+
+    void remap(size_t capacity) {
+        if (data_) {
+            ::munmap(data_, capacity_);
+            data_ = nullptr;
+        }
+        if (::ftruncate(fd_, static_cast<off_t>(capacity)) != 0) {
+            throw std::runtime_error("Cannot grow task journal");
+        }
+        void* mapped = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (mapped == MAP_FAILED) {
+            throw std::runtime_error("Cannot map task journal");
+        }
+        data_ = static_cast<char*>(mapped);
+        capacity_ = capacity;
+    }
+
+    static std::vector<JournaledTask> read_unfinished(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            if (errno == ENOENT) {
+                return {};
+            }
+            throw std::runtime_error("Cannot open task journal: " + path);
+        }
+        struct stat info {};
+        ::fstat(fd, &info);
+        auto size = static_cast<size_t>(info.st_size);
+        if (size == 0) {
+            ::close(fd);
+            return {};
+        }
+        void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            throw std::runtime_error("Cannot map task journal: " + path);
+        }
+        std::string_view data(static_cast<const char*>(mapped), size);
+        if (size < sizeof(kMagic) || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+            ::munmap(mapped, size);
+            throw std::runtime_error("Not a task journal: " + path);
+        }
+
+        std::map<std::uint64_t, JournaledTask> unfinished;
+        size_t position = sizeof(kMagic);
+        while (auto record = read_record(data, position)) {
+            BinaryReader reader(record->body);
+            std::uint8_t kind = reader.read_u8();
+            std::uint64_t id = reader.read_varint();
+            if (kind == kSubmit) {
+                std::string_view type = reader.read_bytes();
+                std::string_view config = reader.read_bytes();
+                if (reader.ok()) {
+                    unfinished[id] = JournaledTask{id, std::string(type), std::string(config)};
+                }
+            } else if (kind == kComplete && reader.ok()) {
+                unfinished.erase(id);
+            }
+            position = record->next;
+        }
+        ::munmap(mapped, size);
+
+        std::vector<JournaledTask> tasks;
+        tasks.reserve(unfinished.size());
+        for (auto& [id, task] : unfinished) {
+            tasks.push_back(std::move(task));
+        }
+        return tasks;
+    }
+
+    // Written beside the journal and renamed over it, so a crash leaves
+    // either the old journal or the new one
+    static void write_snapshot(const std::string& path, const std::vector<JournaledTask>& tasks) {
+        std::string image(kMagic, sizeof(kMagic));
+        BinaryWriter writer;
+        for (const auto& task : tasks) {
+            writer.clear();
+            encode_submit(writer, task.id, task.type, task.config);
+            append_record(image, writer.view());
+        }
+
+        std::string temporary = path + ".tmp";
+        int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create task journal: " + temporary);
+        }
+        bool written = true;
+        for (size_t offset = 0; written && offset < image.size();) {
+            ssize_t n = ::write(fd, image.data() + offset, image.size() - offset);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            written = n > 0;
+            offset += written ? static_cast<size_t>(n) : 0;
+        }
+        written = written && ::fsync(fd) == 0;
+        ::close(fd);
+        if (!written || ::rename(temporary.c_str(), path.c_str()) != 0) {
+            ::unlink(temporary.c_str());
+            throw std::runtime_error("Cannot write task journal: " + path);
+        }
+
+        // Makes the rename itself durable
+        std::filesystem::path directory = std::filesystem::path(path).parent_path();
+        int directory_fd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY);
+        if (directory_fd >= 0) {
+            ::fsync(directory_fd);
+            ::close(directory_fd);
+        }
+    }
+};
+
+#else
+
+class TaskJournal {
+public:
+    struct Stats {
+        std::uint64_t appends = 0;
+        std::uint64_t commits = 0;
+        std::uint64_t syncs = 0;
+        size_t bytes = 0;
+    };
+
+    explicit TaskJournal(const std::string& path, const TaskJournalOptions& = {}) {
+        throw std::runtime_error("Task journal requires mmap support: " + path);
+    }
+
+    std::vector<JournaledTask> take_recovered() { return {}; }
+    std::uint64_t submit(std::string_view, std::string_view) { return 0; }
+    void complete(std::uint64_t) {}
+    void commit() {}
+    void reset() {}
+    Stats stats() const { return {}; }
+};
+
+#endif
+
+}
@@ -0,0 +1,100 @@
+// Dense integer ids for task type names
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace dtpf {
+
+using TaskTypeId = std::uint16_t;
+
+// ============================================================================
+// TASK TYPE REGISTRY: interns every task type name once and hands out ids
+// counting up from zero, so per-type state lives in arrays indexed by id.
+// Names are kept for display only.
+// ============================================================================
+
+class TaskTypeRegistry {
+public:
+    static constexpr size_t kMaxTypes = 256;
+
+    static TaskTypeRegistry& instance() {
+        static TaskTypeRegistry registry;
+        return registry;
+    }
+
+    // Returns the id already assigned to name, or assigns the next one
+    TaskTypeId intern(std::string_view name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (auto it = ids_.find(name); it != ids_.end()) {
+            return it->second;
+        }
+        size_t next = count_.load(std::memory_order_relaxed);
+        if (next == kMaxTypes) {
+            throw std::runtime_error("Too many task types, cannot register: " + std::string(name));
+        }
+        names_[next] = std::string(name);
+        auto id = static_cast<TaskTypeId>(next);
+        ids_.emplace(names_[next], id);
+        count_.store(next + 1, std::memory_order_release);
+        return id;
+    }
+
+    std::optional<TaskTypeId> find(std::string_view name) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = ids_.find(name);
+        return it != ids_.end() ? std::optional<TaskTypeId>(it->second) : std::nullopt;
+    }
+
+    // Lock-free: a name never changes once its id is published
+    const std::string& name(TaskTypeId id) const {
+        static const std::string unknown = "<unknown>";
+        return id < size() ? names_[id] : unknown;
+    }
+
+    // Number of ids handed out; every valid id is below this
+    size_t size() const {
+        return count_.load(std::memory_order_acquire);
+    }
+
+private:
+    TaskTypeRegistry() = default;
+
+    mutable std::mutex mutex_;
+    std::array<std::string, kMaxTypes> names_;
+    std::unordered_map<std::string_view, TaskTypeId> ids_; // keys view names_
+    std::atomic<size_t> count_{0};
+};
+
+// String literal usable as a template argument
+template<size_t N>
+struct TaskTypeName {
+    char value[N];
+
+    constexpr TaskTypeName(const char (&name)[N]) {
+        std::copy_n(name, N, value);
+    }
+};
+
+// Id of a fixed type name; interned on first use, then a static load
+template<TaskTypeName Name>
+TaskTypeId task_type_id() {
+    static const TaskTypeId id = TaskTypeRegistry::instance().intern(Name.value);
+    return id;
+}
+
+inline const std::string& task_type_name(TaskTypeId id) {
+    return TaskTypeRegistry::instance().name(id);
+}
+
+}
@@ -1,170 +1,263 @@
 // Main framework integration and example task implementations
 
 #include <iostream>
+#include <fstream>
 #include <string>
 #include <vector>
 #include <memory>
-#include <map>
+#include <memory_resource>
+#include <algorithm>
 #include <thread>
 #include <chrono>
 #include <future>
 #include <functional>
 #include <stdexcept>
 #include <set>
+#include <unordered_map>
+#include <optional>
+#include <string_view>
+#include <span>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <ctime>
+#include <cstdio>
+#include <cstddef>
+#include <type_traits>
+#include <filesystem>
+
+#include "dtpf/admission_queue.hpp"
+#include "dtpf/any_result.hpp"
+#include "dtpf/big_uint.hpp"
+#include "dtpf/binary_codec.hpp"
+#include "dtpf/byte_kernels.hpp"
+#include "dtpf/config_stream.hpp"
+#include "dtpf/homogeneous_batch.hpp"
+#include "dtpf/io_reactor.hpp"
+#include "dtpf/kv_parser.hpp"
+#include "dtpf/loopback_http_server.hpp"
+#include "dtpf/mapped_file.hpp"
+#include "dtpf/perfect_hash.hpp"
+#include "dtpf/prime_sieve.hpp"
+#include "dtpf/processing_result.hpp"
+#include "dtpf/result_cache.hpp"
+#include "dtpf/result_stream.hpp"
+#include "dtpf/single_flight.hpp"
+#include "dtpf/task_base.hpp"
+#include "dtpf/task_config.hpp"
+#include "dtpf/task_journal.hpp"
+#include "dtpf/task_type_registry.hpp"
 
 namespace dtpf {
 
+// Best-effort tasks leave the key out, as their configs did
+inline void append_deadline_kv(std::string& config, std::chrono::milliseconds deadline) {
+    if (deadline.count() != 0) {
+        kv_append(config, "deadline", std::to_string(deadline.count()));
+    }
+}
+
 // ============================================================================
-// RESULT TYPE
+// TASK STORAGE: a batch's tasks and their strings share one monotonic arena
+// and are released together instead of one allocation at a time
 // ============================================================================
 
-struct ProcessingResult {
-    std::string data;
-    int processed_count = 0;
-    std::chrono::system_clock::time_point timestamp;
-    
-    ProcessingResult() : timestamp(std::chrono::system_clock::now()) {}
-    ProcessingResult(const std::string& d, int count) : data(d), processed_count(count), timestamp(std::chrono::system_clock::now()) {}
-    
-    std::string serialize() const {
-        auto time_t = std::chrono::system_clock::to_time_t(timestamp);
-        return data + ":" + std::to_string(processed_count) + ":" + std::to_string(time_t);
-    }
+using TaskAllocator = std::pmr::polymorphic_allocator<std::byte>;
+
+// Heap tasks are deleted; arena tasks are only destroyed, their memory
+// goes back when the arena is released
+struct TaskDeleter {
+    bool arena_owned = false;
     
-    static ProcessingResult deserialize(const std::string& str) {
-        size_t first_colon = str.find(':');
-        size_t second_colon = str.find(':', first_colon + 1);
-        if (first_colon != std::string::npos && second_colon != std::string::npos) {
-            ProcessingResult result;
-            result.data = str.substr(0, first_colon);
-            result.processed_count = std::stoi(str.substr(first_colon + 1, second_colon - first_colon - 1));
-            auto time_t = std::stoi(str.substr(second_colon + 1));
-            result.timestamp = std::chrono::system_clock::from_time_t(time_t);
-            return result;
+    void operator()(TaskBase* task) const noexcept {
+        if (arena_owned) {
+            task->~TaskBase();
+        } else {
+            delete task;
         }
-        return ProcessingResult{str, 0};
     }
 };
 
-// ============================================================================
-// BASE CLASSES
-// ============================================================================
+using TaskPtr = std::unique_ptr<TaskBase, TaskDeleter>;
+using TaskList = std::vector<TaskPtr>;
 
-class TaskBase {
+class TaskArena {
 public:
-    virtual ~TaskBase() = default;
-    virtual std::string execute() = 0;
-    virtual std::string get_type() const = 0;
-    virtual int get_priority() const = 0;
-};
-
-template<typename T>
-concept TaskResult = requires(T t) {
-    { t.serialize() } -> std::convertible_to<std::string>;
-    { T::deserialize(std::string{}) } -> std::same_as<T>;
-    std::movable<T>;
-};
-
-template<TaskResult R>
-class Task : public TaskBase {
-public:
-    virtual R execute_typed() = 0;
-    std::string execute() override {
-        return execute_typed().serialize();
+    explicit TaskArena(size_t initial_bytes = 64 * 1024) : resource_(initial_bytes) {}
+    
+    TaskArena(const TaskArena&) = delete;
+    TaskArena& operator=(const TaskArena&) = delete;
+    
+    TaskAllocator allocator() { return TaskAllocator{&resource_}; }
+    
+    // Tasks constructible with std::allocator_arg keep their strings in the arena
+    template<typename T, typename... Args>
+    std::unique_ptr<T, TaskDeleter> make(Args&&... args) {
+        TaskAllocator alloc = allocator();
+        void* memory = alloc.allocate_bytes(sizeof(T), alignof(T));
+        T* task;
+        if constexpr (std::is_constructible_v<T, std::allocator_arg_t, TaskAllocator, Args...>) {
+            task = ::new (memory) T(std::allocator_arg, alloc, std::forward<Args>(args)...);
+        } else {
+            task = ::new (memory) T(std::forward<Args>(args)...);
+        }
+        return std::unique_ptr<T, TaskDeleter>(task, TaskDeleter{true});
     }
+    
+    // Constructs the task that build() returns by value straight into arena
+    // memory, so no temporary is moved from
+    template<typename T, typename Build>
+    std::unique_ptr<T, TaskDeleter> make_from(Build&& build) {
+        void* memory = allocator().allocate_bytes(sizeof(T), alignof(T));
+        T* task = ::new (memory) T(std::forward<Build>(build)());
+        return std::unique_ptr<T, TaskDeleter>(task, TaskDeleter{true});
+    }
+    
+    // Every task made by this arena must have been destroyed beforehand
+    void release() { resource_.release(); }
+    
+private:
+    std::pmr::monotonic_buffer_resource resource_;
 };
 
 // ============================================================================
 // ALL TASK CLASSES
 // ============================================================================
 
-class ComputationTask : public Task<ProcessingResult> {
+class ComputationTask final : public Task<ProcessingResult> {
 public:
-    ComputationTask(int iterations, const std::string& algorithm = "fibonacci") 
-        : iterations_(iterations), algorithm_(algorithm) {}
+    ComputationTask(std::int64_t iterations, std::string_view algorithm = "fibonacci") 
+        : ComputationTask(std::allocator_arg, TaskAllocator{}, iterations, algorithm) {}
+    
+    ComputationTask(std::allocator_arg_t, TaskAllocator alloc, std::int64_t iterations,
+                    std::string_view algorithm = "fibonacci")
+        : iterations_(iterations), algorithm_(algorithm, alloc) {}
     
     ProcessingResult execute_typed() override {
-        int result = 0;
+        auto n = static_cast<std::uint64_t>(std::max<std::int64_t>(iterations_, 0));
+        BigUint result;
         if (algorithm_ == "fibonacci") {
-            result = fibonacci(iterations_);
+            result = dtpf::fibonacci(n, kMultiplyParallelDepth);
         } else if (algorithm_ == "factorial") {
-            result = factorial(iterations_);
+            result = dtpf::factorial(n, kMultiplyParallelDepth);
         } else if (algorithm_ == "prime_count") {
-            result = count_primes(iterations_);
+            result = dtpf::count_primes(n);
         }
-        std::string result_data = algorithm_ + "_result_" + std::to_string(result);
-        return ProcessingResult{result_data, result};
+        // The data carries the exact value; the count saturates
+        std::uint64_t count = result.to_u64().value_or(std::numeric_limits<std::int64_t>::max());
+        std::string result_data = std::string(algorithm_) + "_result_" + result.to_string();
+        return ProcessingResult{result_data, static_cast<std::int64_t>(
+            std::min<std::uint64_t>(count, std::numeric_limits<std::int64_t>::max()))};
     }
     
     std::string get_type() const override { return "Computation"; }
+    TaskTypeId get_type_id() const override { return task_type_id<"Computation">(); }
     int get_priority() const override { return 8; }
     
-    static ComputationTask from_config(const std::string& config) {
-        int iterations = 10;
-        std::string algorithm = "fibonacci";
-        if (config.find("iterations=") != std::string::npos) {
-            size_t start = config.find("iterations=") + 11;
-            size_t end = config.find(';', start);
-            iterations = std::stoi(config.substr(start, end - start));
-        }
-        if (config.find("algorithm=") != std::string::npos) {
-            size_t start = config.find("algorithm=") + 10;
-            size_t end = config.find(';', start);
-            if (end == std::string::npos) end = config.length();
-            algorithm = config.substr(start, end - start);
-        }
-        return ComputationTask{iterations, algorithm};
-    }
+    // Part of the content key, so results a persisted cache holds from an
+    // older build are not served. Bump whenever any algorithm's output changes.
+    static constexpr int kResultVersion = 3; // 2: 64-bit prime_count, 3: exact fibonacci/factorial
     
-private:
-    int iterations_;
-    std::string algorithm_;
+    // A pure function of its algorithm and iteration count
+    bool is_cacheable() const override { return true; }
+    std::string content_key() const override {
+        std::string key = "Computation;v=";
+        key.append(std::to_string(kResultVersion)).append(";algorithm=").append(algorithm_);
+        key.append(";iterations=").append(std::to_string(iterations_));
+        return key;
+    }
     
-    int fibonacci(int n) {
-        if (n <= 1) return n;
-        int a = 0, b = 1;
-        for (int i = 2; i <= n; ++i) {
-            int temp = a + b;
-            a = b;
-            b = temp;
+    std::optional<std::string> to_config() const override {
+        std::string config;
+        if (!kv_append(config, "algorithm", algorithm_)) {
+            return std::nullopt;
         }
-        return b;
+        kv_append(config, "iterations", std::to_string(iterations_));
+        append_deadline_kv(config, get_deadline());
+        return config;
     }
     
-    int factorial(int n) {
-        if (n <= 1) return 1;
-        int result = 1;
-        for (int i = 2; i <= n; ++i) {
-            result *= i;
-        }
-        return result;
+    size_t memory_footprint() const override {
+        return sizeof(*this) + algorithm_.capacity();
     }
     
-    int count_primes(int limit) {
-        if (limit < 2) return 0;
-        int count = 0;
-        for (int i = 2; i <= limit; ++i) {
-            bool is_prime = true;
-            for (int j = 2; j * j <= i; ++j) {
-                if (i % j == 0) {
-                    is_prime = false;
-                    break;
-                }
-            }
-            if (is_prime) count++;
-        }
-        return count;
+    struct Params {
+        std::int64_t iterations = 10;
+        std::string_view algorithm = "fibonacci";
+        std::chrono::milliseconds deadline{0};
+    };
+    
+    static constexpr KvField<Params> kFields[] = {
+        kv_field<&Params::iterations>("iterations"),
+        kv_field<&Params::algorithm>("algorithm"),
+        kv_field<&Params::deadline>("deadline"),
+    };
+    
+    static ComputationTask from_config(std::string_view config, TaskAllocator alloc = {}) {
+        Params params;
+        parse_kv_or_throw(config, kFields, params);
+        ComputationTask task{std::allocator_arg, alloc, params.iterations, params.algorithm};
+        task.set_deadline(params.deadline);
+        return task;
     }
+    
+private:
+    // Large operands split their products across up to 3^2 threads
+    static constexpr unsigned kMultiplyParallelDepth = 2;
+    
+    std::int64_t iterations_;
+    std::pmr::string algorithm_;
 };
 
-class DataProcessingTask : public Task<ProcessingResult> {
+// "transform=suffix" selects the default transform, as does leaving it out
+inline bool kv_convert(std::string_view value, std::optional<ByteTransform>& out) {
+    if (value == "suffix") {
+        out.reset();
+        return true;
+    }
+    out = parse_byte_transform(value);
+    return out.has_value();
+}
+
+class DataProcessingTask final : public Task<ProcessingResult> {
 public:
-    DataProcessingTask(const std::string& input_data, int multiplier = 1, int priority = 5) 
-        : input_data_(input_data), multiplier_(multiplier), priority_(priority) {}
+    DataProcessingTask(std::string_view input_data, int multiplier = 1, int priority = 5) 
+        : DataProcessingTask(std::allocator_arg, TaskAllocator{}, input_data, multiplier, priority) {}
+    
+    DataProcessingTask(std::allocator_arg_t, TaskAllocator alloc, std::string_view input_data,
+                       int multiplier = 1, int priority = 5)
+        : input_data_(input_data, alloc), multiplier_(multiplier), priority_(priority) {}
+    
+    // Streams records from a file instead of transforming the inline input.
+    // Each line gets the same transform as the inline data and is written to
+    // output_path, or to input_path + ".processed" when that is empty.
+    static DataProcessingTask from_file(std::string_view input_path, std::string_view output_path = {},
+                                        int multiplier = 1, int priority = 5, TaskAllocator alloc = {}) {
+        DataProcessingTask task{std::allocator_arg, alloc, {}, multiplier, priority};
+        task.input_path_ = input_path;
+        task.output_path_ = output_path.empty() ? std::string(input_path) + ".processed" : std::string(output_path);
+        return task;
+    }
+    
+    // Replaces the default suffix transform with a byte kernel
+    void set_transform(std::optional<ByteTransform> transform) { transform_ = transform; }
     
     ProcessingResult execute_typed() override {
+        if (!input_path_.empty()) {
+            return process_file();
+        }
+        if (transform_ && is_reduction(*transform_)) {
+            return reduction_result(reduce_bytes(*transform_, input_data_).value);
+        }
+        if (transform_) {
+            std::string mapped;
+            map_bytes(*transform_, input_data_, mapped);
+            auto count = static_cast<std::int64_t>(mapped.size());
+            return ProcessingResult{std::move(mapped), count};
+        }
         std::this_thread::sleep_for(std::chrono::milliseconds(100 + (multiplier_ * 50)));
-        std::string processed_data = input_data_;
+        std::string processed_data(input_data_);
         for (int i = 0; i < multiplier_; ++i) {
             processed_data += "_processed";
         }
@@ -173,76 +266,283 @@ public:
     }
     
     std::string get_type() const override { return "DataProcessing"; }
+    TaskTypeId get_type_id() const override { return task_type_id<"DataProcessing">(); }
     int get_priority() const override { return priority_; }
     
-    static DataProcessingTask from_config(const std::string& config) {
-        std::string input = "default_data";
-        int multiplier = 1;
-        int priority = 5;
-        
-        if (config.find("input=") != std::string::npos) {
-            size_t start = config.find("input=") + 6;
-            size_t end = config.find(';', start);
-            input = config.substr(start, end - start);
+    std::string content_key() const override {
+        std::string transform = transform_ ? ";transform=" + std::string(byte_transform_name(*transform_)) : "";
+        if (!input_path_.empty()) {
+            return "DataProcessing;file=" + std::string(input_path_) + ";output=" + std::string(output_path_) +
+                   ";multiplier=" + std::to_string(multiplier_) + transform;
         }
-        if (config.find("multiplier=") != std::string::npos) {
-            size_t start = config.find("multiplier=") + 11;
-            size_t end = config.find(';', start);
-            multiplier = std::stoi(config.substr(start, end - start));
+        return "DataProcessing;input=" + std::string(input_data_) + ";multiplier=" + std::to_string(multiplier_) +
+               transform;
+    }
+    
+    std::optional<std::string> to_config() const override {
+        std::string config;
+        bool representable = input_path_.empty()
+            ? kv_append(config, "input", input_data_)
+            : kv_append(config, "file", input_path_) && kv_append(config, "output", output_path_);
+        if (!representable) {
+            return std::nullopt;
+        }
+        if (transform_) {
+            kv_append(config, "transform", byte_transform_name(*transform_));
         }
-        if (config.find("priority=") != std::string::npos) {
-            size_t start = config.find("priority=") + 9;
-            size_t end = config.find(';', start);
-            if (end == std::string::npos) end = config.length();
-            priority = std::stoi(config.substr(start, end - start));
+        kv_append(config, "multiplier", std::to_string(multiplier_));
+        kv_append(config, "priority", std::to_string(priority_));
+        append_deadline_kv(config, get_deadline());
+        return config;
+    }
+    
+    // In-memory input is copied once and grows by a suffix per pass
+    size_t memory_footprint() const override {
+        size_t strings = input_data_.capacity() + input_path_.capacity() + output_path_.capacity();
+        if (!input_path_.empty()) {
+            return sizeof(*this) + strings;
         }
-        return DataProcessingTask{input, multiplier, priority};
+        size_t suffixes = static_cast<size_t>(std::max(multiplier_, 0)) * (sizeof("_processed") - 1);
+        return sizeof(*this) + strings + input_data_.size() + suffixes;
+    }
+    
+    struct Params {
+        std::string_view input = "default_data";
+        std::string_view file;   // when set, replaces input
+        std::string_view output;
+        std::optional<ByteTransform> transform; // empty keeps the suffix transform
+        int multiplier = 1;
+        int priority = 5;
+        std::chrono::milliseconds deadline{0};
+    };
+    
+    static constexpr KvField<Params> kFields[] = {
+        kv_field<&Params::input>("input"),
+        kv_field<&Params::file>("file"),
+        kv_field<&Params::output>("output"),
+        kv_field<&Params::transform>("transform"),
+        kv_field<&Params::multiplier>("multiplier"),
+        kv_field<&Params::priority>("priority"),
+        kv_field<&Params::deadline>("deadline"),
+    };
+    
+    static DataProcessingTask from_config(std::string_view config, TaskAllocator alloc = {}) {
+        Params params;
+        parse_kv_or_throw(config, kFields, params);
+        DataProcessingTask task = params.file.empty()
+            ? DataProcessingTask{std::allocator_arg, alloc, params.input, params.multiplier, params.priority}
+            : from_file(params.file, params.output, params.multiplier, params.priority, alloc);
+        task.set_transform(params.transform);
+        task.set_deadline(params.deadline);
+        return task;
     }
     
 private:
-    std::string input_data_;
+    std::pmr::string input_data_;
+    std::pmr::string input_path_{input_data_.get_allocator()};
+    std::pmr::string output_path_{input_data_.get_allocator()};
+    std::optional<ByteTransform> transform_;
     int multiplier_;
     int priority_;
+    
+    ProcessingResult reduction_result(std::uint64_t value) const {
+        std::string text;
+        if (*transform_ == ByteTransform::Checksum) {
+            char hex[9];
+            std::snprintf(hex, sizeof(hex), "%08x", static_cast<unsigned>(value));
+            text = hex;
+        } else {
+            text = std::to_string(value);
+        }
+        return ProcessingResult{std::string(byte_transform_name(*transform_)) + "=" + text,
+                                static_cast<std::int64_t>(value)};
+    }
+    
+    ProcessingResult process_file() {
+        if (transform_ && is_reduction(*transform_)) {
+            ByteTransform transform = *transform_;
+            ByteReduction total = reduce_file_chunks(
+                std::string(input_path_), ByteReduction{},
+                [transform](std::string_view chunk) { return reduce_bytes(transform, chunk); },
+                [transform](ByteReduction a, ByteReduction b) { return combine_reductions(transform, a, b); });
+            return reduction_result(total.value);
+        }
+        
+        std::ofstream out(std::string(output_path_), std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Cannot open output file: " + std::string(output_path_));
+        }
+        std::string suffix;
+        for (int i = 0; i < multiplier_; ++i) {
+            suffix += "_processed";
+        }
+        
+        auto transform = [&](std::string_view chunk, std::string& output) {
+            if (transform_) {
+                map_bytes(*transform_, chunk, output);
+                return;
+            }
+            output.reserve(chunk.size() + suffix.size() * (std::count(chunk.begin(), chunk.end(), '\n') + 1));
+            while (!chunk.empty()) {
+                size_t newline = chunk.find('\n');
+                std::string_view line = chunk.substr(0, newline);
+                output.append(line).append(suffix);
+                if (newline == std::string_view::npos) {
+                    break;
+                }
+                output.push_back('\n');
+                chunk.remove_prefix(newline + 1);
+            }
+        };
+        auto sink = [&out](std::string_view output) {
+            out.write(output.data(), static_cast<std::streamsize>(output.size()));
+        };
+        std::uint64_t bytes = transform_file_chunks(std::string(input_path_), transform, sink);
+        
+        out.flush();
+        if (!out) {
+            throw std::runtime_error("Failed writing output file: " + std::string(output_path_));
+        }
+        auto count = static_cast<std::int64_t>(bytes);
+        return ProcessingResult{std::string(output_path_), transform_ ? count : count * multiplier_};
+    }
 };
 
-class NetworkTask : public Task<ProcessingResult> {
+class NetworkTask final : public Task<ProcessingResult> {
 public:
-    NetworkTask(const std::string& url, int timeout_ms = 1000) 
-        : url_(url), timeout_ms_(timeout_ms) {}
+    NetworkTask(std::string_view url, int timeout_ms = 1000) 
+        : NetworkTask(std::allocator_arg, TaskAllocator{}, url, timeout_ms) {}
+    
+    NetworkTask(std::allocator_arg_t, TaskAllocator alloc, std::string_view url, int timeout_ms = 1000)
+        : url_(url, alloc), timeout_ms_(timeout_ms) {}
     
     ProcessingResult execute_typed() override {
-        std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms_ / 2));
-        std::string response_data = "Response from " + url_;
-        int response_size = static_cast<int>(response_data.length());
-        return ProcessingResult{response_data, response_size};
+        return start().get();
+    }
+    
+    bool start_any(StartCallback done) override {
+        start_then([done = std::move(done)](std::exception_ptr error, ProcessingResult result) {
+            done(error, error ? AnyResult{} : AnyResult{std::move(result)});
+        });
+        return true;
+    }
+    
+    // Issues the GET on the shared I/O reactor and returns without blocking,
+    // so many requests can be in flight from one thread. timeout_ms covers
+    // queueing behind the host's limits, connecting, sending and receiving.
+    // Responses outside 2xx are errors.
+    std::future<ProcessingResult> start() const {
+        auto promise = std::make_shared<std::promise<ProcessingResult>>();
+        auto future = promise->get_future();
+        start_then([promise](std::exception_ptr error, ProcessingResult result) {
+            if (error) {
+                promise->set_exception(error);
+            } else {
+                promise->set_value(std::move(result));
+            }
+        });
+        return future;
     }
     
     std::string get_type() const override { return "Network"; }
+    TaskTypeId get_type_id() const override { return task_type_id<"Network">(); }
     int get_priority() const override { return 6; }
     
-    static NetworkTask from_config(const std::string& config) {
-        std::string url = "http://example.com";
-        int timeout = 1000;
-        
-        if (config.find("url=") != std::string::npos) {
-            size_t start = config.find("url=") + 4;
-            size_t end = config.find(';', start);
-            url = config.substr(start, end - start);
+    // Applied to the URL's host, for every task, when this task is started
+    void set_host_limits(const HostLimits& limits) { host_limits_ = limits; }
+    const std::optional<HostLimits>& host_limits() const { return host_limits_; }
+    
+    // Responses may change over time, so requests are shared but not cached
+    std::string content_key() const override {
+        return "Network;url=" + std::string(url_) + ";timeout=" + std::to_string(timeout_ms_);
+    }
+    
+    // Idle-connection limits are not config keys and are not written out
+    std::optional<std::string> to_config() const override {
+        std::string config;
+        if (!kv_append(config, "url", url_)) {
+            return std::nullopt;
         }
-        if (config.find("timeout=") != std::string::npos) {
-            size_t start = config.find("timeout=") + 8;
-            size_t end = config.find(';', start);
-            if (end == std::string::npos) end = config.length();
-            timeout = std::stoi(config.substr(start, end - start));
+        kv_append(config, "timeout", std::to_string(timeout_ms_));
+        append_deadline_kv(config, get_deadline());
+        if (host_limits_) {
+            kv_append(config, "max_in_flight", std::to_string(host_limits_->max_in_flight));
+            kv_append(config, "rate", std::to_string(host_limits_->rate));
+            kv_append(config, "burst", std::to_string(host_limits_->burst));
         }
-        return NetworkTask{url, timeout};
+        return config;
+    }
+    
+    size_t memory_footprint() const override {
+        return sizeof(*this) + url_.capacity();
+    }
+    
+    struct Params {
+        std::string_view url = "http://example.com";
+        int timeout = 1000;
+        std::chrono::milliseconds deadline{0};
+        size_t max_in_flight = 0;
+        size_t rate = 0;
+        size_t burst = 0;
+    };
+    
+    static constexpr KvField<Params> kFields[] = {
+        kv_field<&Params::url>("url"),
+        kv_field<&Params::timeout>("timeout"),
+        kv_field<&Params::deadline>("deadline"),
+        kv_field<&Params::max_in_flight>("max_in_flight"),
+        kv_field<&Params::rate>("rate"),
+        kv_field<&Params::burst>("burst"),
+    };
+    
+    static NetworkTask from_config(std::string_view config, TaskAllocator alloc = {}) {
+        Params params;
+        parse_kv_or_throw(config, kFields, params);
+        NetworkTask task{std::allocator_arg, alloc, params.url, params.timeout};
+        task.set_deadline(params.deadline);
+        if (params.max_in_flight || params.rate || params.burst) {
+            HostLimits limits;
+            limits.max_in_flight = params.max_in_flight;
+            limits.rate = params.rate;
+            limits.burst = params.burst;
+            task.set_host_limits(limits);
+        }
+        return task;
     }
     
 private:
-    std::string url_;
+    // done(error, result) is called exactly once, on a reactor thread or on
+    // this one when the request is rejected up front
+    template<typename Done>
+    void start_then(Done done) const {
+#ifdef DTPF_HAS_EPOLL
+        std::string url(url_);
+        IoReactor::shared().get(url, std::chrono::milliseconds(timeout_ms_),
+                                [done = std::move(done), url](std::exception_ptr error, HttpResponse response) {
+            if (!error && response.status / 100 != 2) {
+                error = std::make_exception_ptr(
+                    std::runtime_error("GET " + url + ": HTTP " + std::to_string(response.status)));
+            }
+            if (error) {
+                done(error, ProcessingResult{});
+                return;
+            }
+            auto size = static_cast<std::int64_t>(response.body.size());
+            done(nullptr, ProcessingResult{std::move(response.body), size});
+        }, host_limits_);
+#else
+        done(std::make_exception_ptr(std::runtime_error("NetworkTask requires epoll support")), ProcessingResult{});
+#endif
+    }
+    
+    std::pmr::string url_;
     int timeout_ms_;
+    std::optional<HostLimits> host_limits_;
 };
 
+// Built-in tasks grouped by concrete type for devirtualized execution
+using BuiltinTaskBatch = HomogeneousBatch<ComputationTask, DataProcessingTask, NetworkTask>;
+
 // ============================================================================
 // SUPPORTING CLASSES
 // ============================================================================
@@ -257,9 +557,32 @@ enum class ExecutionStrategy {
 class ExecutionEngine {
 public:
     void set_execution_strategy(ExecutionStrategy strategy) { strategy_ = strategy; }
+    void set_stream_options(const StreamOptions& options) { stream_options_ = options; }
+    void set_result_cache(std::shared_ptr<ResultCache> cache) { result_cache_ = std::move(cache); }
+    void set_single_flight(bool enabled) { single_flight_enabled_ = enabled; }
+    SingleFlight<AnyResult>::Stats single_flight_stats() const { return single_flight_.stats(); }
+    
+    // Runs one task on the calling thread, as each strategy does
+    AnyResult execute_one(TaskBase& task) const {
+        return run_task(task);
+    }
+    
+    // Called with a task's index on the thread that ran it, before its result
+    // is handed back; applies to task lists, not batches
+    using CompletionHook = std::function<void(size_t index)>;
+    void set_completion_hook(CompletionHook hook) { completion_hook_ = std::move(hook); }
     
-    std::vector<std::string> execute(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
+    std::vector<std::string> execute(const TaskList& tasks) {
         std::vector<std::string> results;
+        results.reserve(tasks.size());
+        for (const auto& result : execute_typed(tasks)) {
+            results.push_back(result.to_string());
+        }
+        return results;
+    }
+    
+    // Results stay in their native type until a caller asks for text
+    std::vector<AnyResult> execute_typed(const TaskList& tasks) {
         switch (strategy_) {
             case ExecutionStrategy::Sequential:
                 return execute_sequential(tasks);
@@ -270,57 +593,290 @@ public:
         }
     }
 
+    // Hand each result to on_result as soon as its task completes
+    void execute_streaming(const TaskList& tasks, const ResultCallback& on_result) {
+        execute_streaming_typed(tasks, [&on_result](size_t i, AnyResult result) {
+            on_result(i, result.to_string());
+        });
+    }
+    
+    // Statically dispatched path for tasks already grouped by concrete type
+    template<typename... Tasks>
+    std::vector<AnyResult> execute_batch(HomogeneousBatch<Tasks...>& batch) {
+        if (strategy_ == ExecutionStrategy::Parallel) {
+            return batch.execute_parallel(stream_options_.max_in_flight);
+        }
+        return batch.execute_sequential();
+    }
+    
+    void execute_streaming_typed(const TaskList& tasks,
+                                 const TypedResultCallback& on_result) {
+        if (strategy_ == ExecutionStrategy::Parallel) {
+            // Started tasks finish on reactor threads, so the completion hook
+            // runs for them here, just before delivery
+            TaskStarter starter(single_flight_enabled_, result_cache_ != nullptr);
+            std::vector<char> started(tasks.size(), 0);
+            stream_results_with_start(tasks.size(), [&](size_t i) { return run_at(tasks, i); },
+                [&](size_t i, const StreamDelivery<AnyResult>& deliver) {
+                    started[i] = starter.start(*tasks[i], deliver);
+                    return started[i] != 0;
+                },
+                [&](size_t i, AnyResult result) {
+                    if (started[i] && completion_hook_) {
+                        completion_hook_(i);
+                    }
+                    on_result(i, std::move(result));
+                }, stream_options_);
+            return;
+        }
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            on_result(i, run_at(tasks, i));
+        }
+    }
+
 private:
     ExecutionStrategy strategy_ = ExecutionStrategy::Sequential;
+    StreamOptions stream_options_;
+    std::shared_ptr<ResultCache> result_cache_;
+    bool single_flight_enabled_ = true;
+    mutable SingleFlight<AnyResult> single_flight_;
+    CompletionHook completion_hook_;
     
-    std::vector<std::string> execute_sequential(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
-        std::vector<std::string> results;
-        for (const auto& task : tasks) {
-            try {
-                results.push_back(task->execute());
-            } catch (const std::exception& e) {
-                results.push_back("Error: " + std::string(e.what()));
+    AnyResult run_at(const TaskList& tasks, size_t index) const {
+        AnyResult result = run_task(*tasks[index]);
+        if (completion_hook_) {
+            completion_hook_(index);
+        }
+        return result;
+    }
+    
+    AnyResult run_task(TaskBase& task) const {
+        try {
+            std::string key = (single_flight_enabled_ || result_cache_) ? task.content_key() : std::string{};
+            if (key.empty()) {
+                return task.execute_any();
             }
+            auto run = [&] {
+                return result_cache_ && task.is_cacheable() ? run_cached(task, key) : task.execute_any();
+            };
+            return single_flight_enabled_ ? single_flight_.run(key, run) : run();
+        } catch (const std::exception& e) {
+            return AnyResult{"Error: " + std::string(e.what())};
+        }
+    }
+    
+    // Failures propagate to run_task and are never cached
+    AnyResult run_cached(TaskBase& task, const std::string& key) const {
+        if (auto bytes = result_cache_->get(key)) {
+            AnyResult cached = task.decode_result(*bytes);
+            if (cached.has_value()) {
+                return cached;
+            }
+            result_cache_->erase(key);
+        }
+        AnyResult result = task.execute_any();
+        if (auto bytes = task.encode_result(result)) {
+            result_cache_->put(key, *bytes);
+        }
+        return result;
+    }
+    
+    std::vector<AnyResult> execute_sequential(const TaskList& tasks) {
+        std::vector<AnyResult> results;
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            results.push_back(run_at(tasks, i));
         }
         return results;
     }
     
-    std::vector<std::string> execute_parallel(const std::vector<std::unique_ptr<TaskBase>>& tasks) {
-        std::vector<std::future<std::string>> futures;
-        for (const auto& task : tasks) {
-            futures.push_back(std::async(std::launch::async, [&task]() {
-                try {
-                    return task->execute();
-                } catch (const std::exception& e) {
-                    return std::string("Error: ") + e.what();
-                }
-            }));
+    // Tasks with a start hook are all started before the rest are launched
+    std::vector<AnyResult> execute_parallel(const TaskList& tasks) {
+        TaskStarter starter(single_flight_enabled_, result_cache_ != nullptr);
+        std::vector<std::future<AnyResult>> futures(tasks.size());
+        std::vector<char> started(tasks.size(), 0);
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            auto promise = std::make_shared<std::promise<AnyResult>>();
+            started[i] = starter.start(*tasks[i], [promise](AnyResult result) {
+                promise->set_value(std::move(result));
+            });
+            if (started[i]) {
+                futures[i] = promise->get_future();
+            }
         }
-        std::vector<std::string> results;
-        for (auto& future : futures) {
-            results.push_back(future.get());
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            if (!started[i]) {
+                futures[i] = std::async(std::launch::async, [this, &tasks, i]() {
+                    return run_at(tasks, i);
+                });
+            }
+        }
+        std::vector<AnyResult> results;
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            results.push_back(futures[i].get());
+            if (started[i] && completion_hook_) {
+                completion_hook_(i);
+            }
         }
         return results;
     }
+    
+    // Starts tasks through TaskBase::start_any, so their waits overlap instead
+    // of each holding a thread. Tasks a result cache would serve are left to
+    // run_task. With single flight on, tasks with equal content keys started
+    // through one starter share one start, whose result goes to all of them.
+    class TaskStarter {
+    public:
+        TaskStarter(bool share_keys, bool cache_enabled) : share_keys_(share_keys), cache_enabled_(cache_enabled) {}
+        
+        // True when the task was started; deliver(AnyResult) is then called
+        // exactly once, from any thread
+        bool start(TaskBase& task, std::function<void(AnyResult)> deliver) {
+            if (cache_enabled_ && task.is_cacheable()) {
+                return false;
+            }
+            std::string key = share_keys_ ? task.content_key() : std::string{};
+            if (!key.empty()) {
+                if (auto it = started_.find(key); it != started_.end()) {
+                    it->second->join(std::move(deliver));
+                    return true;
+                }
+            }
+            auto shared = std::make_shared<SharedStart>();
+            shared->waiting.push_back(std::move(deliver));
+            bool started = true;
+            try {
+                started = task.start_any([shared](std::exception_ptr error, AnyResult result) {
+                    shared->finish(error ? error_result(error) : std::move(result));
+                });
+            } catch (...) {
+                shared->finish(error_result(std::current_exception()));
+            }
+            if (started && !key.empty()) {
+                started_.emplace(std::move(key), std::move(shared));
+            }
+            return started;
+        }
+        
+    private:
+        // Outlives the starter when results arrive late
+        struct SharedStart {
+            std::mutex mutex;
+            bool done = false;
+            AnyResult result;
+            std::vector<std::function<void(AnyResult)>> waiting;
+            
+            void join(std::function<void(AnyResult)> deliver) {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (!done) {
+                    waiting.push_back(std::move(deliver));
+                    return;
+                }
+                AnyResult copy = result;
+                lock.unlock();
+                deliver(std::move(copy));
+            }
+            
+            void finish(AnyResult value) {
+                std::vector<std::function<void(AnyResult)>> ready;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    done = true;
+                    result = std::move(value);
+                    ready.swap(waiting);
+                }
+                for (auto& deliver : ready) {
+                    deliver(result); // no writer once done is set
+                }
+            }
+        };
+        
+        static AnyResult error_result(std::exception_ptr error) {
+            try {
+                std::rethrow_exception(error);
+            } catch (const std::exception& e) {
+                return AnyResult{"Error: " + std::string(e.what())};
+            } catch (...) {
+                return AnyResult{std::string("Error: unknown exception")};
+            }
+        }
+        
+        bool share_keys_;
+        bool cache_enabled_;
+        std::unordered_map<std::string, std::shared_ptr<SharedStart>> started_;
+    };
 };
 
+// Types are registered at startup and then frozen into a perfect-hashed
+// table, after which creation is one hash probe and a direct call
 class TaskFactory {
 public:
-    using TaskCreator = std::function<std::unique_ptr<TaskBase>(const std::string&)>;
+    // Creates on the heap when arena is null
+    using TaskCreator = TaskPtr (*)(const std::string& config, TaskArena* arena);
     
     template<typename T>
     void register_task(const std::string& type_name) {
-        creators_[type_name] = [](const std::string& config) -> std::unique_ptr<TaskBase> {
-            return std::make_unique<T>(T::from_config(config));
-        };
+        std::lock_guard<std::mutex> lock(registration_mutex_);
+        TaskTypeId id = TaskTypeRegistry::instance().intern(type_name);
+        TaskCreator creator = &create<T>;
+        if (id < creators_.size() && creators_[id] == creator) {
+            return; // registering the same type again is harmless
+        }
+        if (frozen()) {
+            throw std::runtime_error("Task factory is frozen, cannot register: " + type_name);
+        }
+        if (id >= creators_.size()) {
+            creators_.resize(id + 1);
+        }
+        creators_[id] = creator;
     }
     
-    std::unique_ptr<TaskBase> create_task(const std::string& type, const std::string& config) {
-        auto it = creators_.find(type);
-        if (it != creators_.end()) {
-            return it->second(config);
+    // Closes registration and builds the lookup table. The first create call
+    // freezes the factory if this was not called explicitly.
+    void freeze() {
+        std::lock_guard<std::mutex> lock(registration_mutex_);
+        if (frozen()) {
+            return;
+        }
+        std::vector<std::pair<std::string, Entry>> entries;
+        for (size_t id = 0; id < creators_.size(); ++id) {
+            if (creators_[id]) {
+                auto type = static_cast<TaskTypeId>(id);
+                entries.push_back({task_type_name(type), Entry{type, creators_[id]}});
+            }
+        }
+        lookup_ = PerfectHashMap<Entry>(std::move(entries));
+        frozen_.store(true, std::memory_order_release);
+    }
+    
+    bool frozen() const {
+        return frozen_.load(std::memory_order_acquire);
+    }
+    
+    TaskPtr create_task(const std::string& type, const std::string& config) {
+        return find_entry(type).create(config, nullptr);
+    }
+    
+    TaskPtr create_task(const std::string& type, const std::string& config, TaskArena& arena) {
+        return find_entry(type).create(config, &arena);
+    }
+    
+    TaskPtr create_task(TaskTypeId type, const std::string& config, TaskArena* arena = nullptr) {
+        return find_creator(type)(config, arena);
+    }
+    
+    // Fills the caller's slots with one task per config, each constructed in
+    // place in arena memory when an arena is given
+    void create_tasks(std::span<const TaskConfig> configs, std::span<TaskPtr> out, TaskArena* arena = nullptr) {
+        if (out.size() < configs.size()) {
+            throw std::invalid_argument("Output storage is smaller than the config list");
+        }
+        std::string parameters;
+        for (size_t i = 0; i < configs.size(); ++i) {
+            const Entry& entry = find_entry(configs[i].type);
+            parameters.clear();
+            configs[i].append_parameters(parameters);
+            out[i] = entry.create(parameters, arena);
         }
-        throw std::runtime_error("Unknown task type: " + type);
     }
     
     static TaskFactory& instance() {
@@ -329,7 +885,43 @@ public:
     }
     
 private:
-    std::map<std::string, TaskCreator> creators_;
+    struct Entry {
+        TaskTypeId id;
+        TaskCreator create;
+    };
+    
+    std::mutex registration_mutex_;
+    std::vector<TaskCreator> creators_; // indexed by TaskTypeId
+    PerfectHashMap<Entry> lookup_;       // built by freeze()
+    std::atomic<bool> frozen_{false};
+    
+    template<typename T>
+    static TaskPtr create(const std::string& config, TaskArena* arena) {
+        if (arena) {
+            return arena->make_from<T>([&] { return T::from_config(config, arena->allocator()); });
+        }
+        return TaskPtr(new T(T::from_config(config)));
+    }
+    
+    const Entry& find_entry(std::string_view type) {
+        if (!frozen()) {
+            freeze();
+        }
+        if (const Entry* entry = lookup_.find(type)) {
+            return *entry;
+        }
+        throw std::runtime_error("Unknown task type: " + std::string(type));
+    }
+    
+    TaskCreator find_creator(TaskTypeId type) {
+        if (!frozen()) {
+            freeze();
+        }
+        if (type < creators_.size() && creators_[type]) {
+            return creators_[type];
+        }
+        throw std::runtime_error("Unknown task type: " + task_type_name(type));
+    }
 };
 
 // ============================================================================
@@ -338,6 +930,9 @@ private:
 
 class DistributedTaskProcessor {
 public:
+    // Receives each service result with the ticket its submission returned
+    using ServiceCallback = std::function<void(std::uint64_t ticket, AnyResult result)>;
+    
     DistributedTaskProcessor() {
         TaskFactory::instance().register_task<DataProcessingTask>("DataProcessing");
         TaskFactory::instance().register_task<NetworkTask>("Network");
@@ -345,6 +940,10 @@ public:
         execution_engine_.set_execution_strategy(ExecutionStrategy::Parallel);
     }
     
+    ~DistributedTaskProcessor() {
+        stop_service();
+    }
+    
     void set_execution_strategy(ExecutionStrategy strategy) {
         execution_engine_.set_execution_strategy(strategy);
     }
@@ -358,6 +957,7 @@ public:
         std::cout << "Executing " << pending_tasks_.size() << " tasks...\n";
         auto start_time = std::chrono::high_resolution_clock::now();
         
+        sync_journal();
         auto results = execution_engine_.execute(pending_tasks_);
         
         auto end_time = std::chrono::high_resolution_clock::now();
@@ -367,35 +967,372 @@ public:
         return results;
     }
     
+    // Typed variant for in-process consumers: no result is formatted as text
+    std::vector<AnyResult> execute_all_tasks_typed() {
+        if (pending_tasks_.empty()) {
+            return {};
+        }
+        sync_journal();
+        return execution_engine_.execute_typed(pending_tasks_);
+    }
+    
+    // Streaming variant: results arrive in completion order with their task index
+    void execute_all_tasks_streaming(const ResultCallback& on_result) {
+        if (pending_tasks_.empty()) {
+            std::cout << "No tasks to execute.\n";
+            return;
+        }
+        
+        std::cout << "Streaming " << pending_tasks_.size() << " tasks...\n";
+        auto start_time = std::chrono::high_resolution_clock::now();
+        
+        sync_journal();
+        execution_engine_.execute_streaming(pending_tasks_, on_result);
+        
+        auto end_time = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+        
+        std::cout << "Streaming completed in " << duration.count() << "ms\n";
+    }
+    
+    void set_stream_options(const StreamOptions& options) {
+        execution_engine_.set_stream_options(options);
+    }
+    
+    // Runs the task blocks of a config file as they are parsed instead of
+    // after the whole file has been read. Tasks go straight from the factory
+    // to the workers and are freed when they finish, so memory stays bounded
+    // by the options rather than by the file. The pending list is untouched.
+    // Results carry each task's position among the file's task blocks; a
+    // task that cannot be created is reported as an error result. Returns
+    // the number of tasks read.
+    size_t execute_config_file_streaming(const std::string& path, const TypedResultCallback& on_result,
+                                         const ConfigStreamOptions& options = {}) {
+        std::cout << "Streaming tasks from " << path << "...\n";
+        auto start_time = std::chrono::high_resolution_clock::now();
+        
+        size_t count = stream_config_file(path, [this](TaskConfig&& config) {
+            return run_streamed_task(config);
+        }, on_result, options);
+        
+        auto end_time = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+        
+        std::cout << "Streamed " << count << " tasks in " << duration.count() << "ms\n";
+        return count;
+    }
+    
+    // Reuses results of cacheable tasks across batches and, with a
+    // persist_path, across runs
+    void enable_result_cache(const ResultCacheOptions& options = {}) {
+        result_cache_ = std::make_shared<ResultCache>(options);
+        execution_engine_.set_result_cache(result_cache_);
+    }
+    
+    ResultCache::Stats result_cache_stats() const {
+        return result_cache_ ? result_cache_->stats() : ResultCache::Stats{};
+    }
+    
+    SingleFlight<AnyResult>::Stats single_flight_stats() const {
+        return execution_engine_.single_flight_stats();
+    }
+    
+    // Records every submission and completion in a write-ahead journal at
+    // path. Tasks an earlier run submitted but did not finish are added back
+    // to the pending list, and their count is returned. Submissions are made
+    // durable when execution starts, or by sync_journal(); a completion is
+    // durable before its result is handed back. Results themselves are not
+    // journaled. Every task added afterwards must support to_config().
+    size_t enable_journal(const std::string& path, const TaskJournalOptions& options = {}) {
+        if (!pending_tasks_.empty()) {
+            throw std::runtime_error("Enable the task journal before adding tasks");
+        }
+        journal_ = std::make_unique<TaskJournal>(path, options);
+        auto recovered = journal_->take_recovered();
+        try {
+            for (const auto& task : recovered) {
+                pending_tasks_.push_back(TaskFactory::instance().create_task(task.type, task.config, task_arena_));
+                journal_ids_.push_back(task.id);
+            }
+        } catch (...) {
+            pending_tasks_.clear();
+            journal_ids_.clear();
+            journal_.reset();
+            throw;
+        }
+        execution_engine_.set_completion_hook([this](size_t index) {
+            journal_->complete(journal_ids_[index]);
+            journal_->commit();
+        });
+        return recovered.size();
+    }
+    
+    void sync_journal() {
+        if (journal_) {
+            journal_->commit();
+        }
+    }
+    
+    TaskJournal::Stats journal_stats() const {
+        return journal_ ? journal_->stats() : TaskJournal::Stats{};
+    }
+    
+    std::vector<std::string> execute_batch(BuiltinTaskBatch& batch) {
+        std::cout << "Executing batch of " << batch.size() << " tasks...\n";
+        auto start_time = std::chrono::high_resolution_clock::now();
+        
+        std::vector<std::string> results;
+        results.reserve(batch.size());
+        for (const auto& result : execution_engine_.execute_batch(batch)) {
+            results.push_back(result.to_string());
+        }
+        
+        auto end_time = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+        
+        std::cout << "Batch completed in " << duration.count() << "ms\n";
+        return results;
+    }
+    
     template<typename TaskType, typename... Args>
-    void create_and_add_task(Args&&... args) {
-        auto task = std::make_unique<TaskType>(std::forward<Args>(args)...);
+    TaskType& create_and_add_task(Args&&... args) {
+        auto task = task_arena_.make<TaskType>(std::forward<Args>(args)...);
+        TaskType& added = *task;
         pending_tasks_.push_back(std::move(task));
+        journal_added_tasks(pending_tasks_.size() - 1);
+        return added;
+    }
+    
+    TaskBase& add_task_from_config(const std::string& type, const std::string& config) {
+        pending_tasks_.push_back(TaskFactory::instance().create_task(type, config, task_arena_));
+        journal_added_tasks(pending_tasks_.size() - 1);
+        return *pending_tasks_.back();
+    }
+    
+    void add_tasks_from_configs(std::span<const TaskConfig> configs) {
+        size_t first = pending_tasks_.size();
+        pending_tasks_.resize(first + configs.size());
+        try {
+            TaskFactory::instance().create_tasks(configs, std::span(pending_tasks_).subspan(first), &task_arena_);
+        } catch (...) {
+            pending_tasks_.resize(first);
+            throw;
+        }
+        journal_added_tasks(first);
+    }
+    
+    // ========================================================================
+    // SERVICE MODE: a long-running alternative to the pending list. Each
+    // submission is admitted against the limits in options or handled by its
+    // overload policy, and max_in_flight workers run admitted tasks as they
+    // arrive, highest priority first. Service tasks live on the heap and are
+    // freed as soon as they finish. on_result runs on the worker threads.
+    // A task shed to make room is reported to on_result as an error.
+    // ========================================================================
+    
+    void start_service(const AdmissionOptions& options, ServiceCallback on_result) {
+        if (service_) {
+            throw std::runtime_error("Task service is already running");
+        }
+        service_ = std::make_unique<Service>(options, std::move(on_result));
+        for (size_t i = 0; i < std::max<size_t>(options.max_in_flight, 1); ++i) {
+            service_->workers.emplace_back([this] { run_service_worker(); });
+        }
+    }
+    
+    template<typename TaskType, typename... Args>
+    Admission submit_task(Args&&... args) {
+        return submit(TaskPtr(new TaskType(std::forward<Args>(args)...)));
+    }
+    
+    Admission submit_from_config(const std::string& type, const std::string& config) {
+        return submit(TaskFactory::instance().create_task(type, config));
     }
     
+    // Refuses further submissions, runs what was admitted and joins the workers
+    void stop_service() {
+        if (!service_) {
+            return;
+        }
+        service_->queue.close();
+        for (auto& worker : service_->workers) {
+            worker.join();
+        }
+        service_.reset();
+    }
+    
+    AdmissionStats service_stats() const {
+        return service_ ? service_->queue.stats() : AdmissionStats{};
+    }
+    
+    // Destroys the batch and hands its arena memory back in one step. The
+    // cleared tasks are completed in the journal; service and streamed
+    // submissions it also holds stay there until they finish.
     void clear_tasks() {
         pending_tasks_.clear();
+        task_arena_.release();
+        if (journal_) {
+            for (std::uint64_t id : journal_ids_) {
+                journal_->complete(id);
+            }
+            journal_->commit();
+            journal_ids_.clear();
+        }
     }
     
     void print_task_summary() const {
         std::cout << "\n=== Task Summary ===\n";
         std::cout << "Total tasks: " << pending_tasks_.size() << "\n";
         
-        std::map<std::string, int> task_type_counts;
+        std::vector<int> task_type_counts;
         for (const auto& task : pending_tasks_) {
-            task_type_counts[task->get_type()]++;
+            TaskTypeId type = task->get_type_id();
+            if (type >= task_type_counts.size()) {
+                task_type_counts.resize(type + 1);
+            }
+            task_type_counts[type]++;
         }
         
+        // Names are only looked up for the types present, listed alphabetically
+        std::vector<TaskTypeId> present;
+        for (size_t type = 0; type < task_type_counts.size(); ++type) {
+            if (task_type_counts[type] > 0) {
+                present.push_back(static_cast<TaskTypeId>(type));
+            }
+        }
+        std::sort(present.begin(), present.end(), [](TaskTypeId a, TaskTypeId b) {
+            return task_type_name(a) < task_type_name(b);
+        });
+        
         std::cout << "Task types:\n";
-        for (const auto& [type, count] : task_type_counts) {
-            std::cout << "  " << type << ": " << count << "\n";
+        for (TaskTypeId type : present) {
+            std::cout << "  " << task_type_name(type) << ": " << task_type_counts[type] << "\n";
         }
         std::cout << "==================\n\n";
     }
 
 private:
     ExecutionEngine execution_engine_;
-    std::vector<std::unique_ptr<TaskBase>> pending_tasks_;
+    std::shared_ptr<ResultCache> result_cache_;
+    TaskArena task_arena_; // declared before pending_tasks_ so it outlives them
+    TaskList pending_tasks_;
+    std::unique_ptr<TaskJournal> journal_;
+    std::vector<std::uint64_t> journal_ids_; // journal id of each pending task
+    
+    struct ServiceTask {
+        TaskPtr task;
+        std::uint64_t journal_id = 0;
+    };
+    
+    struct Service {
+        Service(const AdmissionOptions& options, ServiceCallback callback)
+            : queue(options), on_result(std::move(callback)) {}
+        
+        AdmissionQueue<ServiceTask> queue;
+        ServiceCallback on_result;
+        std::vector<std::thread> workers;
+    };
+    std::unique_ptr<Service> service_;
+    
+    Admission submit(TaskPtr task) {
+        if (!service_) {
+            throw std::runtime_error("Task service is not running");
+        }
+        ServiceTask item{std::move(task)};
+        if (journal_) {
+            auto config = item.task->to_config();
+            if (!config) {
+                throw std::invalid_argument("Task cannot be journaled: " + item.task->get_type());
+            }
+            item.journal_id = journal_->submit(item.task->get_type(), *config);
+        }
+        
+        std::vector<AdmissionQueue<ServiceTask>::Lease> shed;
+        int priority = item.task->get_priority();
+        size_t bytes = item.task->memory_footprint();
+        std::uint64_t journal_id = item.journal_id;
+        Admission admission = service_->queue.push(std::move(item), priority, bytes, shed);
+        if (journal_) {
+            // Refused and shed tasks will never run, so a restart must not revive them
+            if (!admission.admitted()) {
+                journal_->complete(journal_id);
+            }
+            for (const auto& lease : shed) {
+                journal_->complete(lease.item.journal_id);
+            }
+        }
+        for (auto& lease : shed) {
+            service_->on_result(lease.ticket, AnyResult{std::string("Error: Shed under overload")});
+        }
+        return admission;
+    }
+    
+    void run_service_worker() {
+        while (auto lease = service_->queue.pop()) {
+            if (journal_) {
+                journal_->commit(); // the submission is durable before the task runs
+            }
+            auto start = std::chrono::steady_clock::now();
+            AnyResult result = execution_engine_.execute_one(*lease->item.task);
+            auto run_time = std::chrono::steady_clock::now() - start;
+            if (journal_) {
+                journal_->complete(lease->item.journal_id);
+                journal_->commit();
+            }
+            service_->on_result(lease->ticket, std::move(result));
+            lease->item.task.reset();
+            service_->queue.finish(*lease, run_time);
+        }
+    }
+    
+    // Journaled like a service task: durable before it runs, completed after
+    AnyResult run_streamed_task(const TaskConfig& config) {
+        TaskPtr task;
+        std::uint64_t journal_id = 0;
+        try {
+            std::string parameters;
+            config.append_parameters(parameters);
+            task = TaskFactory::instance().create_task(config.type, parameters);
+            if (journal_) {
+                auto journaled = task->to_config();
+                if (!journaled) {
+                    throw std::invalid_argument("Task cannot be journaled: " + task->get_type());
+                }
+                journal_id = journal_->submit(task->get_type(), *journaled);
+                journal_->commit();
+            }
+        } catch (const std::exception& e) {
+            return AnyResult{"Error: " + std::string(e.what())};
+        }
+        AnyResult result = execution_engine_.execute_one(*task);
+        if (journal_) {
+            journal_->complete(journal_id);
+            journal_->commit();
+        }
+        return result;
+    }
+    
+    // Journals the tasks from index first on. If any of them cannot be
+    // written out, none is journaled and all of them are removed again.
+    void journal_added_tasks(size_t first) {
+        if (!journal_) {
+            return;
+        }
+        std::vector<std::string> configs;
+        configs.reserve(pending_tasks_.size() - first);
+        for (size_t i = first; i < pending_tasks_.size(); ++i) {
+            auto config = pending_tasks_[i]->to_config();
+            if (!config) {
+                std::string type = pending_tasks_[i]->get_type();
+                pending_tasks_.resize(first);
+                throw std::invalid_argument("Task cannot be journaled: " + type);
+            }
+            configs.push_back(std::move(*config));
+        }
+        for (size_t i = first; i < pending_tasks_.size(); ++i) {
+            journal_ids_.push_back(journal_->submit(pending_tasks_[i]->get_type(), configs[i - first]));
+        }
+    }
 };
 
 } // namespace dtpf
@@ -411,10 +1348,11 @@ int main() {
     
     try {
         DistributedTaskProcessor processor;
+        LoopbackHttpServer http_server; // stands in for the remote services below
         
         std::cout << "1. Manual Task Creation Example:\n";
         processor.create_and_add_task<DataProcessingTask>("sample_data_1", 2, 8);
-        processor.create_and_add_task<NetworkTask>("https://api.example.com", 500);
+        processor.create_and_add_task<NetworkTask>(http_server.url("/delay/250"), 500);
         processor.create_and_add_task<ComputationTask>(15, "fibonacci");
         processor.create_and_add_task<DataProcessingTask>("sample_data_2", 1, 5);
         
@@ -434,7 +1372,7 @@ int main() {
         std::cout << "\n2. Strategy Comparison Example:\n";
         processor.create_and_add_task<DataProcessingTask>("dataset_1", 1, 7);
         processor.create_and_add_task<ComputationTask>(10, "factorial");
-        processor.create_and_add_task<NetworkTask>("https://service.example.com", 300);
+        processor.create_and_add_task<NetworkTask>(http_server.url("/delay/150"), 300);
         
         std::vector<ExecutionStrategy> strategies = {
             ExecutionStrategy::Sequential,
@@ -456,6 +1394,92 @@ int main() {
                       << " - Duration: " << duration.count() << "ms\n";
         }
         
+        std::cout << "\n3. Streaming Results Example:\n";
+        processor.set_execution_strategy(ExecutionStrategy::Parallel);
+        processor.execute_all_tasks_streaming([](size_t index, std::string result) {
+            std::cout << "Task " << index + 1 << " finished: " << result << "\n";
+        });
+        
+        std::cout << "\n4. Homogeneous Batch Example:\n";
+        BuiltinTaskBatch batch;
+        batch.emplace<ComputationTask>(20, "fibonacci");
+        batch.emplace<NetworkTask>(http_server.url("/delay/100"), 200);
+        batch.emplace<ComputationTask>(12, "factorial");
+        batch.emplace<ComputationTask>(100, "prime_count");
+        auto batch_results = processor.execute_batch(batch);
+        for (size_t i = 0; i < batch_results.size(); ++i) {
+            std::cout << "Task " << i + 1 << ": " << batch_results[i] << "\n";
+        }
+        
+        std::cout << "\n5. Result Cache Example:\n";
+        processor.clear_tasks();
+        processor.enable_result_cache();
+        processor.set_execution_strategy(ExecutionStrategy::Sequential);
+        for (int i = 0; i < 3; ++i) {
+            processor.create_and_add_task<ComputationTask>(30, "fibonacci");
+        }
+        processor.execute_all_tasks();
+        processor.execute_all_tasks();
+        auto cache_stats = processor.result_cache_stats();
+        std::cout << "Cache hits: " << cache_stats.hits << ", misses: " << cache_stats.misses << "\n";
+        
+        std::cout << "\n6. Task Journal Example:\n";
+        std::string journal_path = (std::filesystem::temp_directory_path() / "dtpf_demo.journal").string();
+        std::filesystem::remove(journal_path);
+        {
+            // Submissions reach the journal, then the process "stops" before running them
+            DistributedTaskProcessor first_run;
+            first_run.enable_journal(journal_path);
+            first_run.create_and_add_task<ComputationTask>(25, "fibonacci");
+            first_run.create_and_add_task<DataProcessingTask>("journaled_data", 1, 7);
+            first_run.sync_journal();
+        }
+        DistributedTaskProcessor restarted;
+        std::cout << "Recovered " << restarted.enable_journal(journal_path) << " unfinished tasks\n";
+        auto recovered_results = restarted.execute_all_tasks();
+        for (size_t i = 0; i < recovered_results.size(); ++i) {
+            std::cout << "Task " << i + 1 << ": " << recovered_results[i] << "\n";
+        }
+        restarted.clear_tasks();
+        std::filesystem::remove(journal_path);
+        
+        std::cout << "\n7. Admission Control Example:\n";
+        AdmissionOptions admission;
+        admission.max_in_flight = 2;
+        admission.max_queued = 2;
+        admission.policy = OverloadPolicy::Reject;
+        std::atomic<int> finished{0};
+        processor.start_service(admission, [&finished](std::uint64_t, AnyResult) { ++finished; });
+        int rejected = 0;
+        for (int i = 0; i < 8; ++i) {
+            Admission submitted = processor.submit_task<DataProcessingTask>("burst_" + std::to_string(i), 1, 5);
+            if (!submitted.admitted()) {
+                ++rejected;
+                std::cout << "Task " << i + 1 << " rejected, retry after " << submitted.retry_after.count() << "ms\n";
+            }
+        }
+        processor.stop_service();
+        std::cout << "Finished: " << finished << ", rejected: " << rejected << "\n";
+        
+        std::cout << "\n8. Streaming Config Example:\n";
+        std::string config_path = (std::filesystem::temp_directory_path() / "dtpf_demo.conf").string();
+        {
+            std::ofstream config_file(config_path);
+            config_file << "# Blocks start running as soon as each one closes\n";
+            for (int i = 0; i < 6; ++i) {
+                config_file << "task: Computation {\n    iterations = \"" << 10 + i
+                            << "\"\n    algorithm = \"fibonacci\"\n}\n";
+            }
+            config_file << "task: DataProcessing {\n    input = \"streamed_data\"\n    multiplier = \"4\"\n}\n";
+        }
+        ConfigStreamOptions stream_options;
+        stream_options.max_in_flight = 2;
+        stream_options.queue_capacity = 4;
+        processor.execute_config_file_streaming(config_path, [](size_t index, AnyResult result) {
+            std::cout << "Task " << index + 1 << " finished: " << result.to_string() << "\n";
+        }, stream_options);
+        std::filesystem::remove(config_path);
+        
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
@@ -5,6 +5,10 @@
 #include <type_traits>
 #include <functional>
 #include <tuple>
+#include <optional>
+#include <string_view>
+
+#include "dtpf/binary_codec.hpp"
 
 namespace dtpf {
 
@@ -18,6 +22,16 @@ concept Serializable = requires(T t) {
     { T::deserialize(std::string{}) } -> std::same_as<T>;
 };
 
+// Binary wire format: encode into a BinaryWriter, decode either into a
+// zero-copy View over the input bytes or into an owning value
+template<typename T>
+concept BinarySerializable = requires(const T& t, BinaryWriter& writer, std::string_view bytes) {
+    typename T::View;
+    { t.serialize_binary(writer) } -> std::same_as<void>;
+    { T::view_binary(bytes) } -> std::same_as<std::optional<typename T::View>>;
+    { T::deserialize_binary(bytes) } -> std::same_as<std::optional<T>>;
+};
+
 template<typename T>
 concept TaskResult = std::movable<T> && Serializable<T>;
 
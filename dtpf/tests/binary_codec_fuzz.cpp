@@ -0,0 +1,250 @@
+// Randomized round trips through BinaryWriter/BinaryReader and the binary
+// form of ProcessingResult, plus truncated, mutated and garbage input fed
+// to the reader. Build with -fsanitize=address,undefined to catch any read
+// past the input; every input is copied into an exactly sized allocation so
+// such a read lands outside it. Defining DTPF_LIBFUZZER and building with
+// -fsanitize=fuzzer runs the garbage-input checks under libFuzzer instead.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "dtpf/binary_codec.hpp"
+#include "dtpf/processing_result.hpp"
+
+using namespace dtpf;
+
+namespace {
+
+void require(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "binary codec check failed: %s\n", what);
+        std::abort();
+    }
+}
+
+// Owns an exact-size copy of some bytes
+class Exact {
+public:
+    explicit Exact(std::string_view bytes) : size_(bytes.size()), data_(new char[bytes.size()]) {
+        if (size_ > 0) {
+            std::memcpy(data_.get(), bytes.data(), size_);
+        }
+    }
+
+    std::string_view view() const { return {data_.get(), size_}; }
+
+    bool contains(std::string_view inner) const {
+        return inner.empty() || (inner.data() >= data_.get() && inner.data() + inner.size() <= data_.get() + size_);
+    }
+
+private:
+    size_t size_;
+    std::unique_ptr<char[]> data_;
+};
+
+using Rng = std::mt19937_64;
+
+// Mostly the encoding boundaries, otherwise a random value of random width
+std::uint64_t random_u64(Rng& rng) {
+    static const std::uint64_t edges[] = {0, 1, 127, 128, 16383, 16384, (1ull << 35) - 1, 1ull << 63,
+                                          ~std::uint64_t{0}, ~std::uint64_t{0} >> 1};
+    if (rng() % 4 == 0) {
+        return edges[rng() % std::size(edges)];
+    }
+    unsigned width = static_cast<unsigned>(rng() % 64) + 1;
+    return width == 64 ? rng() : rng() & ((1ull << width) - 1);
+}
+
+std::string random_bytes(Rng& rng, size_t max_size) {
+    std::string bytes(rng() % (max_size + 1), '\0');
+    for (auto& c : bytes) {
+        c = static_cast<char>(rng()); // includes ':' and NUL
+    }
+    return bytes;
+}
+
+struct Field {
+    enum class Kind { U8, Varint, Signed, Fixed64, Bytes };
+
+    Kind kind;
+    std::uint64_t value = 0;
+    std::string bytes;
+};
+
+std::vector<Field> random_fields(Rng& rng) {
+    std::vector<Field> fields(rng() % 16 + 1);
+    for (auto& field : fields) {
+        field.kind = static_cast<Field::Kind>(rng() % 5);
+        field.value = random_u64(rng);
+        if (field.kind == Field::Kind::U8) {
+            field.value &= 0xFF;
+        } else if (field.kind == Field::Kind::Bytes) {
+            field.bytes = random_bytes(rng, 300); // long enough for a two-byte length
+        }
+    }
+    return fields;
+}
+
+std::string encode(const std::vector<Field>& fields) {
+    BinaryWriter writer;
+    for (const auto& field : fields) {
+        switch (field.kind) {
+            case Field::Kind::U8: writer.write_u8(static_cast<std::uint8_t>(field.value)); break;
+            case Field::Kind::Varint: writer.write_varint(field.value); break;
+            case Field::Kind::Signed: writer.write_signed(static_cast<std::int64_t>(field.value)); break;
+            case Field::Kind::Fixed64: writer.write_fixed64(field.value); break;
+            case Field::Kind::Bytes: writer.write_bytes(field.bytes); break;
+        }
+    }
+    return writer.take();
+}
+
+// True when every field reads back equal and the reader is still ok
+bool decode_matches(BinaryReader& reader, const Exact& input, const std::vector<Field>& fields) {
+    bool equal = true;
+    for (const auto& field : fields) {
+        switch (field.kind) {
+            case Field::Kind::U8: equal &= reader.read_u8() == field.value; break;
+            case Field::Kind::Varint: equal &= reader.read_varint() == field.value; break;
+            case Field::Kind::Signed: equal &= reader.read_signed() == static_cast<std::int64_t>(field.value); break;
+            case Field::Kind::Fixed64: equal &= reader.read_fixed64() == field.value; break;
+            case Field::Kind::Bytes: {
+                std::string_view bytes = reader.read_bytes();
+                require(input.contains(bytes), "read_bytes returned a view outside the input");
+                equal &= bytes == field.bytes;
+                break;
+            }
+        }
+        require(reader.position() <= input.view().size(), "reader moved past the end of its input");
+    }
+    return equal && reader.ok();
+}
+
+// Cut points to try: all of them for short encodings, a sample otherwise
+std::vector<size_t> prefixes(Rng& rng, size_t size) {
+    std::vector<size_t> cuts;
+    if (size <= 64) {
+        for (size_t cut = 0; cut < size; ++cut) {
+            cuts.push_back(cut);
+        }
+    } else {
+        for (int i = 0; i < 16; ++i) {
+            cuts.push_back(rng() % size);
+        }
+    }
+    return cuts;
+}
+
+void check_fields(Rng& rng) {
+    auto fields = random_fields(rng);
+    std::string encoded = encode(fields);
+
+    Exact whole(encoded);
+    BinaryReader reader(whole.view());
+    require(decode_matches(reader, whole, fields), "fields did not round-trip");
+    require(reader.at_end(), "round trip left bytes unread");
+
+    for (size_t cut : prefixes(rng, encoded.size())) {
+        Exact truncated(std::string_view(encoded).substr(0, cut));
+        BinaryReader partial(truncated.view());
+        decode_matches(partial, truncated, fields);
+        require(!partial.ok(), "a truncated encoding decoded as ok");
+    }
+}
+
+void check_result(Rng& rng) {
+    ProcessingResult result{random_bytes(rng, 64), static_cast<std::int64_t>(random_u64(rng))};
+    auto seconds = static_cast<std::time_t>(rng() % 8'000'000'000) - 4'000'000'000; // within system_clock's range
+    result.timestamp = std::chrono::system_clock::from_time_t(seconds);
+    std::string encoded = result.to_binary();
+
+    Exact whole(encoded);
+    auto view = ProcessingResult::view_binary(whole.view());
+    require(view.has_value(), "a ProcessingResult encoding was rejected");
+    require(whole.contains(view->data), "view_binary data points outside the input");
+    auto decoded = ProcessingResult::deserialize_binary(whole.view());
+    require(decoded && decoded->data == result.data && decoded->processed_count == result.processed_count &&
+                std::chrono::system_clock::to_time_t(decoded->timestamp) == seconds,
+            "ProcessingResult did not round-trip");
+
+    for (size_t cut : prefixes(rng, encoded.size())) {
+        Exact truncated(std::string_view(encoded).substr(0, cut));
+        require(!ProcessingResult::view_binary(truncated.view()), "a truncated ProcessingResult decoded");
+    }
+    Exact extended(encoded + static_cast<char>(rng()));
+    require(!ProcessingResult::view_binary(extended.view()), "trailing bytes were accepted");
+}
+
+// Arbitrary input: reads stay in bounds, and once failed the reader stays
+// failed and returns nothing
+void check_garbage(std::string_view bytes, std::uint64_t seed) {
+    Exact input(bytes);
+    if (auto view = ProcessingResult::view_binary(input.view())) {
+        require(input.contains(view->data), "view_binary data points outside garbage input");
+    }
+
+    Rng rng(seed);
+    BinaryReader reader(input.view());
+    bool failed = false;
+    for (size_t step = 0; step <= bytes.size() + 2; ++step) {
+        std::uint64_t value = 0;
+        std::string_view view;
+        switch (rng() % 5) {
+            case 0: value = reader.read_u8(); break;
+            case 1: value = reader.read_varint(); break;
+            case 2: value = static_cast<std::uint64_t>(reader.read_signed()); break;
+            case 3: value = reader.read_fixed64(); break;
+            case 4: view = reader.read_bytes(); break;
+        }
+        require(input.contains(view), "read_bytes returned a view outside garbage input");
+        require(reader.position() <= bytes.size(), "reader moved past the end of garbage input");
+        if (failed) {
+            require(!reader.ok() && value == 0 && view.empty(), "a failed reader produced data");
+        }
+        failed = !reader.ok();
+    }
+}
+
+}
+
+#ifdef DTPF_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, size_t size) {
+    std::string_view bytes(reinterpret_cast<const char*>(data), size);
+    check_garbage(bytes, size);
+    return 0;
+}
+
+#else
+
+int main(int argc, char* argv[]) {
+    size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    std::uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : std::random_device{}();
+
+    Rng rng(seed);
+    for (size_t i = 0; i < iterations; ++i) {
+        check_fields(rng);
+        check_result(rng);
+        check_garbage(random_bytes(rng, 64), rng());
+
+        // Valid encodings with a few bytes overwritten reach deeper than noise
+        std::string mutated = ProcessingResult{random_bytes(rng, 32), 42}.to_binary();
+        for (int flips = static_cast<int>(rng() % 3) + 1; flips > 0; --flips) {
+            mutated[rng() % mutated.size()] = static_cast<char>(rng());
+        }
+        check_garbage(mutated, rng());
+    }
+    std::printf("%zu iterations passed (seed %llu)\n", iterations, static_cast<unsigned long long>(seed));
+    return 0;
+}
+
+#endif
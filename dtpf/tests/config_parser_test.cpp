@@ -0,0 +1,217 @@
+// ConfigParser against the regular-expression scans it replaced, plus route
+// conditions and syntax error positions. The parser's translation unit is
+// included, so these checks run the shipped code.
+
+#include <cstdio>
+#include <map>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../config_parser.cpp"
+
+using namespace dtpf;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+        ++failures;
+    }
+}
+
+// What both parsers produced, in comparable form
+struct Parsed {
+    std::vector<TaskConfig> tasks;
+    std::vector<std::pair<std::string, std::map<std::string, std::string>>> nodes;
+    std::vector<std::vector<std::string>> routes; // from, to, condition
+    std::vector<std::vector<std::string>> pipelines;
+};
+
+bool same_tasks(const std::vector<TaskConfig>& a, const std::vector<TaskConfig>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].type != b[i].type || a[i].properties != b[i].properties || a[i].priority != b[i].priority ||
+            a[i].node_assignment != b[i].node_assignment) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The scans of the regex ConfigParser, each over the whole config
+Parsed parse_with_regex(const std::string& config) {
+    static const std::regex task_pattern{R"(task\s*:\s*(\w+)\s*\{([^}]*)\})"};
+    static const std::regex node_pattern{R"(node\s*:\s*(\w+)\s*\{([^}]*)\})"};
+    static const std::regex property_pattern("(\\w+)\\s*=\\s*\"([^\"]*)\"");
+    static const std::regex routing_pattern{R"(route\s*:\s*(\w+)\s*->\s*(\w+)(?:\s*where\s+(.+))?)"};
+    static const std::regex pipeline_pattern{R"(pipeline\s*:\s*(.+))"};
+    static const std::regex stage_delimiter{R"(\s*->\s*)"};
+    std::sregex_iterator end;
+    Parsed parsed;
+
+    for (std::sregex_iterator it(config.begin(), config.end(), task_pattern); it != end; ++it) {
+        TaskConfig task;
+        task.type = (*it)[1].str();
+        std::string properties = (*it)[2].str();
+        for (std::sregex_iterator p(properties.begin(), properties.end(), property_pattern); p != end; ++p) {
+            std::string key = (*p)[1].str();
+            task.properties[key] = (*p)[2].str();
+            if (key == "priority") {
+                task.priority = std::stoi((*p)[2].str());
+            } else if (key == "node") {
+                task.node_assignment = (*p)[2].str();
+            }
+        }
+        parsed.tasks.push_back(std::move(task));
+    }
+    for (std::sregex_iterator it(config.begin(), config.end(), node_pattern); it != end; ++it) {
+        std::string properties = (*it)[2].str();
+        std::map<std::string, std::string> values;
+        for (std::sregex_iterator p(properties.begin(), properties.end(), property_pattern); p != end; ++p) {
+            values[(*p)[1].str()] = (*p)[2].str();
+        }
+        parsed.nodes.emplace_back((*it)[1].str(), std::move(values));
+    }
+    for (std::sregex_iterator it(config.begin(), config.end(), routing_pattern); it != end; ++it) {
+        parsed.routes.push_back({(*it)[1].str(), (*it)[2].str(), (*it)[3].matched ? (*it)[3].str() : ".*"});
+    }
+    for (std::sregex_iterator it(config.begin(), config.end(), pipeline_pattern); it != end; ++it) {
+        std::string stages = (*it)[1].str();
+        std::vector<std::string> split;
+        for (std::sregex_token_iterator s(stages.begin(), stages.end(), stage_delimiter, -1);
+             s != std::sregex_token_iterator{}; ++s) {
+            if (s->length() > 0) {
+                split.push_back(s->str());
+            }
+        }
+        parsed.pipelines.push_back(std::move(split));
+    }
+    return parsed;
+}
+
+Parsed parse_with_parser(const std::string& config) {
+    auto result = ConfigParser::parse(config);
+    Parsed parsed;
+    parsed.tasks = std::move(result.tasks);
+    for (auto& node : result.nodes) {
+        parsed.nodes.emplace_back(node.name, node.properties);
+    }
+    for (auto& route : result.routes) {
+        parsed.routes.push_back({route.from_node, route.to_node, route.condition_string});
+    }
+    for (auto& pipeline : result.pipelines) {
+        parsed.pipelines.push_back(pipeline.stages);
+    }
+    return parsed;
+}
+
+std::string make_config(size_t blocks) {
+    std::string config = "global {\n    threads = \"4\"\n    banner = \"} {\"\n    limits { depth = 2 }\n}\n";
+    for (size_t i = 0; i < blocks; ++i) {
+        std::string n = std::to_string(i);
+        config.append("# block ").append(n);
+        config.append("\nnode: worker").append(n);
+        config.append(" {\n    address = \"10.0.").append(std::to_string(i % 256));
+        config.append(".1\"\n    port = \"9000\"\n    max_workers = \"8\"\n}\n");
+        config.append("task: Computation {\n    iterations = \"").append(std::to_string(i % 40));
+        config.append("\"\n    algorithm = \"fibonacci\"\n    priority = \"").append(std::to_string(i % 10));
+        config.append("\"\n    node = \"worker").append(n).append("\"\n}\n");
+        config.append("task: DataProcessing { input = \"dataset_").append(n).append("\"; multiplier = \"3\" }\n");
+        config.append("route: ingest").append(n).append(" -> worker").append(n);
+        config.append(i % 3 == 0 ? " where status == ok\n" : "\n");
+        config.append("pipeline: load -> transform -> store\n");
+    }
+    return config;
+}
+
+void check_equivalence() {
+    std::string config = make_config(500);
+    Parsed expected = parse_with_regex(config);
+    Parsed actual = parse_with_parser(config);
+    check(expected.tasks.size() == 1000, "the generated config has 1000 tasks");
+    check(same_tasks(actual.tasks, expected.tasks), "tasks match the regex parser");
+    check(actual.nodes == expected.nodes, "nodes match the regex parser");
+    check(actual.routes == expected.routes, "routes match the regex parser");
+    check(actual.pipelines == expected.pipelines, "pipelines match the regex parser");
+}
+
+// Sections other than tasks, nodes, routes and pipelines are skipped
+void check_other_sections() {
+    std::string config = "global { threads = \"4\" }\ntask: Computation {\n    iterations = \"5\"\n}\n";
+    check(ConfigParser::extract_section(config, "global") == " threads = \"4\" ", "extract_section reads global");
+    check(ConfigParser::parse_tasks(config).size() == 1, "a global section does not hide the task");
+    check(ConfigParser::validate_config(config), "a config with a global section validates");
+    check(same_tasks(ConfigParser::parse_tasks(config), parse_with_regex(config).tasks),
+          "a config with a global section parses as the regex parser did");
+}
+
+// Route conditions as RoutingRule::matches applies them
+void check_conditions() {
+    struct Case {
+        const char* condition;
+        const char* data;
+        bool expected;
+    };
+    const Case cases[] = {
+        {"status == ok", "status: ok", true},
+        {"status == ok", "status: bad", false},
+        {"status != bad", "status: bad", false},
+        {"status != bad", "id: 7\nstatus : bad", false},
+        {"status != bad", "status: ok", true},
+        {"status != bad", "", true},
+    };
+    for (const auto& c : cases) {
+        auto rules = ConfigParser::parse_routing(std::string("route: a -> b where ") + c.condition + "\n");
+        bool matched = rules.size() == 1 && rules[0].matches(c.data);
+        check(matched == c.expected, std::string("condition '") + c.condition + "' on '" + c.data + "'");
+    }
+    auto rules = ConfigParser::parse_routing("route: a -> b\n");
+    check(rules.size() == 1 && rules[0].matches("anything"), "a route without a condition matches everything");
+}
+
+void check_errors() {
+    struct Case {
+        const char* config;
+        size_t line;
+        size_t column;
+    };
+    const Case cases[] = {
+        {"tsak: X { }", 1, 1},
+        {"task: X {\n    a = 4\n}", 2, 9},
+        {"node: n {\n    port = \"x\"\n}", 2, 12},
+        {"\n\nglobal { a = \"}\"", 3, 1},
+        {"route: a b", 1, 10},
+    };
+    for (const auto& c : cases) {
+        try {
+            ConfigParser::parse(c.config);
+            check(false, std::string("no error for '") + c.config + "'");
+        } catch (const ConfigSyntaxError& e) {
+            check(e.line() == c.line && e.column() == c.column,
+                  std::string("error position for '") + c.config + "': " + e.what());
+        }
+    }
+}
+
+}
+
+int main() {
+    check_equivalence();
+    check_other_sections();
+    check_conditions();
+    check_errors();
+    if (failures > 0) {
+        std::fprintf(stderr, "%d config parser checks failed\n", failures);
+        return 1;
+    }
+    std::printf("config parser checks passed\n");
+    return 0;
+}
@@ -0,0 +1,244 @@
+// TaskSorter and ExecutionEngine::execute_batch against std::stable_sort
+// and plain loops. The engine's translation unit is included, so these
+// checks run the shipped code.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../execution_engine.cpp"
+
+using namespace dtpf;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+        ++failures;
+    }
+}
+
+struct Spec {
+    size_t id;
+    std::string type;
+    int priority;
+    std::chrono::milliseconds deadline;
+};
+
+class TestTask : public TaskBase {
+public:
+    explicit TestTask(const Spec& spec) : spec_(spec) {}
+
+    std::string execute() override { return std::to_string(spec_.id); }
+    std::string get_type() const override { return spec_.type; }
+    int get_priority() const override { return spec_.priority; }
+    size_t id() const { return spec_.id; }
+
+private:
+    Spec spec_;
+};
+
+using TaskList = std::vector<std::unique_ptr<TaskBase>>;
+
+// Types are interned out of alphabetical order, so ranking them matters
+std::vector<Spec> make_specs(size_t count, std::mt19937_64& rng) {
+    static const char* types[] = {"Gamma", "Alpha", "Delta", "Beta"};
+    static const int edges[] = {INT_MIN, INT_MIN + 1, -1, 0, 1, INT_MAX - 1, INT_MAX};
+    std::vector<Spec> specs(count);
+    for (size_t i = 0; i < count; ++i) {
+        specs[i].id = i;
+        specs[i].type = types[rng() % std::size(types)];
+        specs[i].priority = rng() % 8 == 0 ? edges[rng() % std::size(edges)] : static_cast<int>(rng() % 11) - 5;
+        specs[i].deadline = std::chrono::milliseconds(rng() % 4 == 0 ? 0 : rng() % 1000 + 1);
+    }
+    return specs;
+}
+
+TaskList make_tasks(const std::vector<Spec>& specs) {
+    TaskList tasks;
+    for (const auto& spec : specs) {
+        tasks.push_back(std::make_unique<TestTask>(spec));
+    }
+    return tasks;
+}
+
+std::vector<size_t> ids_of(const TaskList& tasks) {
+    std::vector<size_t> ids;
+    for (const auto& task : tasks) {
+        ids.push_back(static_cast<const TestTask&>(*task).id());
+    }
+    return ids;
+}
+
+template<typename Less>
+std::vector<size_t> stable_order(std::vector<Spec> specs, Less&& less) {
+    std::stable_sort(specs.begin(), specs.end(), less);
+    std::vector<size_t> ids;
+    for (const auto& spec : specs) {
+        ids.push_back(spec.id);
+    }
+    return ids;
+}
+
+auto by_priority_descending = [](const Spec& a, const Spec& b) { return a.priority > b.priority; };
+auto by_priority_ascending = [](const Spec& a, const Spec& b) { return a.priority < b.priority; };
+auto by_type = [](const Spec& a, const Spec& b) { return a.type < b.type; };
+
+void check_task_lists(const std::vector<Spec>& specs) {
+    TaskList tasks = make_tasks(specs);
+    TaskSorter::sort_by_priority(tasks);
+    check(ids_of(tasks) == stable_order(specs, by_priority_descending), "sort_by_priority, descending");
+
+    tasks = make_tasks(specs);
+    TaskSorter::sort_by_priority(tasks, false);
+    check(ids_of(tasks) == stable_order(specs, by_priority_ascending), "sort_by_priority, ascending");
+
+    tasks = make_tasks(specs);
+    TaskSorter::sort_by_type(tasks);
+    check(ids_of(tasks) == stable_order(specs, by_type), "sort_by_type");
+
+    tasks = make_tasks(specs);
+    auto groups = TaskSorter::group_by_priority(tasks);
+    check(tasks.empty(), "group_by_priority empties its input");
+    TaskList flattened;
+    for (size_t g = 0; g < groups.size(); ++g) {
+        check(!groups[g].empty(), "group_by_priority makes no empty groups");
+        int priority = groups[g].front()->get_priority();
+        check(std::all_of(groups[g].begin(), groups[g].end(),
+                          [&](const auto& task) { return task->get_priority() == priority; }),
+              "a group holds one priority");
+        if (g > 0) {
+            check(groups[g - 1].back()->get_priority() > priority, "groups are highest priority first");
+        }
+    }
+    for (auto& group : groups) {
+        std::move(group.begin(), group.end(), std::back_inserter(flattened));
+    }
+    check(ids_of(flattened) == stable_order(specs, by_priority_descending), "group_by_priority order");
+}
+
+TaskBatch make_batch(const std::vector<Spec>& specs) {
+    TaskBatch batch;
+    for (const auto& spec : specs) {
+        batch.add(TaskTypeRegistry::instance().intern(spec.type), spec.priority, std::to_string(spec.id),
+                  spec.deadline);
+    }
+    return batch;
+}
+
+std::vector<size_t> ids_of(const TaskBatch& batch) {
+    std::vector<size_t> ids;
+    for (size_t row = 0; row < batch.size(); ++row) {
+        ids.push_back(std::stoul(std::string(batch.params(row))));
+    }
+    return ids;
+}
+
+void check_batches(const std::vector<Spec>& specs) {
+    TaskBatch batch = make_batch(specs);
+    TaskSorter::sort_by_priority(batch);
+    check(ids_of(batch) == stable_order(specs, by_priority_descending), "batch sort_by_priority");
+
+    batch = make_batch(specs);
+    TaskSorter::sort_by_type(batch);
+    check(ids_of(batch) == stable_order(specs, by_type), "batch sort_by_type");
+
+    batch = make_batch(specs);
+    auto runs = TaskSorter::group_by_priority(batch);
+    check(ids_of(batch) == stable_order(specs, by_priority_descending), "batch group_by_priority order");
+    size_t expected_begin = 0;
+    for (size_t r = 0; r < runs.size(); ++r) {
+        check(runs[r].begin == expected_begin && runs[r].end > runs[r].begin, "priority runs tile the batch");
+        auto priorities = batch.priorities().subspan(runs[r].begin, runs[r].end - runs[r].begin);
+        check(std::all_of(priorities.begin(), priorities.end(), [&](int p) { return p == priorities[0]; }),
+              "a priority run holds one priority");
+        if (r > 0) {
+            check(batch.priorities()[runs[r - 1].begin] > priorities[0], "priority runs are highest first");
+        }
+        expected_begin = runs[r].end;
+    }
+    check(expected_begin == batch.size(), "priority runs cover the batch");
+
+    batch = make_batch(specs);
+    auto type_runs = TaskSorter::group_by_type(batch);
+    check(ids_of(batch) == stable_order(specs, by_type), "batch group_by_type order");
+    std::vector<std::string> run_types;
+    for (const auto& run : type_runs) {
+        run_types.push_back(task_type_name(batch.type_ids()[run.begin]));
+    }
+    check(std::is_sorted(run_types.begin(), run_types.end()) &&
+              std::adjacent_find(run_types.begin(), run_types.end()) == run_types.end(),
+          "type runs are one per type, alphabetical");
+}
+
+// Every row runs once and its result lands in its own slot, under each
+// strategy; failures become error results
+void check_execute_batch(const std::vector<Spec>& specs) {
+    const ExecutionStrategy strategies[] = {ExecutionStrategy::Sequential, ExecutionStrategy::Parallel,
+                                            ExecutionStrategy::Adaptive, ExecutionStrategy::EarliestDeadline};
+    for (ExecutionStrategy strategy : strategies) {
+        std::string name = "execute_batch, strategy " + std::to_string(static_cast<int>(strategy));
+        TaskBatch batch = make_batch(specs);
+        ExecutionEngine engine;
+        engine.set_execution_strategy(strategy);
+        std::vector<std::atomic<int>> runs(specs.size());
+        engine.execute_batch(batch, [&](TaskTypeId type, std::string_view params) {
+            size_t id = std::stoul(std::string(params));
+            ++runs[id];
+            if (id % 97 == 0) {
+                throw std::runtime_error("row " + std::to_string(id));
+            }
+            return task_type_name(type) + ":" + std::string(params);
+        });
+
+        check(std::all_of(runs.begin(), runs.end(), [](const std::atomic<int>& n) { return n == 1; }),
+              name + ": every row runs exactly once");
+        auto results = batch.results();
+        bool all_match = results.size() == specs.size();
+        for (size_t row = 0; all_match && row < batch.size(); ++row) {
+            size_t id = std::stoul(std::string(batch.params(row)));
+            std::string expected = id % 97 == 0 ? "Error: row " + std::to_string(id) : specs[id].type + ":" + std::to_string(id);
+            all_match = results[row].to_string() == expected;
+        }
+        check(all_match, name + ": results are stored in their rows");
+
+        if (strategy == ExecutionStrategy::EarliestDeadline) {
+            auto by_deadline = [](const Spec& a, const Spec& b) {
+                auto key = [](const Spec& s) { return s.deadline.count() <= 0 ? INT64_MAX : s.deadline.count(); };
+                return key(a) < key(b);
+            };
+            check(ids_of(batch) == stable_order(specs, by_deadline), name + ": rows run earliest deadline first");
+        }
+    }
+}
+
+}
+
+int main() {
+    std::mt19937_64 rng(20261018);
+    for (size_t count : {0, 1, 2, 17, 1000, 20000}) {
+        auto specs = make_specs(count, rng);
+        check_task_lists(specs);
+        check_batches(specs);
+        if (count > 0) {
+            check_execute_batch(specs);
+        }
+    }
+    if (failures > 0) {
+        std::fprintf(stderr, "%d task sorter checks failed\n", failures);
+        return 1;
+    }
+    std::printf("task sorter checks passed\n");
+    return 0;
+}